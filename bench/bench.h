@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef _NRF_HW_MODELS_BENCH_H
+#define _NRF_HW_MODELS_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "bs_types.h"
+
+typedef struct {
+  const char *name;
+  void (*setup)(void);     /* Optional, run before measuring */
+  void (*run)(uint64_t n); /* Run the measured operation <n> times */
+  void (*teardown)(void);  /* Optional, run after measuring */
+} bench_case_t;
+
+typedef struct {
+  const char *name;
+  bool (*run)(void);       /* Returns true if the models behaved as expected */
+} bench_check_t;
+
+/* bench_cases.c */
+extern const bench_case_t bench_cases[];
+extern const unsigned int bench_n_cases;
+extern const bench_check_t bench_checks[];
+extern const unsigned int bench_n_checks;
+
+/* bench_time_machine.c */
+void bench_tm_run_until(bs_time_t end);
+void bench_tm_run_until_event(volatile uint32_t *event, bs_time_t timeout);
+
+/* bench_phy_stub.c */
+void bench_phy_set_rx_packet(const uint8_t *packet, size_t size);
+const uint8_t *bench_phy_get_tx_packet(size_t *size);
+void bench_phy_set_rx_start_cb(void (*cb)(void));
+
+#endif /* _NRF_HW_MODELS_BENCH_H */
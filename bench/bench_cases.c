@@ -0,0 +1,585 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * The benchmark cases
+ *
+ * Each case configures the peripherals thru their registers, as the SW would,
+ * and measures one operation. Operations which take simulated time (a radio
+ * packet, an AAR resolution, a flash write...) include running the HW models
+ * until they are done.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "nrfx.h"
+#include "time_machine_if.h"
+#include "irq_ctrl.h"
+#include "crc.h"
+#include "NRF_PPI.h"
+#include "NRF_TIMER.h"
+#include "NRF_RTC.h"
+#include "NRF_RADIO.h"
+#include "NRF_AAR.h"
+#include "NRF_AES_CCM.h"
+#include "NRF_NVMC.h"
+#include "bench.h"
+
+/* Value for the 32 bit pointer registers */
+#define ADDR32(x) ((uint32_t)(uintptr_t)&(x))
+
+#define BLE_CRC_INIT 0x555555
+
+/*
+ * PPI: one event (TIMER0 COMPARE[0]) fanned out to <n_ch> channels,
+ * each triggering a capture in TIMER1 or TIMER2
+ */
+static void ppi_fanout_setup(unsigned int n_ch){
+  nrf_timer_TASK_START(1);
+  nrf_timer_TASK_START(2);
+  for (unsigned int ch = 0; ch < n_ch; ch++) {
+    NRF_PPI_regs.CH[ch].EEP = ADDR32(NRF_TIMER_regs[0].EVENTS_COMPARE[0]);
+    nrf_ppi_regw_sideeffects_EEP(ch);
+    NRF_PPI_regs.CH[ch].TEP = ADDR32(NRF_TIMER_regs[1 + ch/4].TASKS_CAPTURE[ch%4]);
+    nrf_ppi_regw_sideeffects_TEP(ch);
+  }
+  NRF_PPI_regs.CHENSET = (1 << n_ch) - 1;
+  nrf_ppi_regw_sideeffects_CHENSET();
+}
+
+static void ppi_fanout_1_setup(void){
+  ppi_fanout_setup(1);
+}
+
+static void ppi_fanout_8_setup(void){
+  ppi_fanout_setup(8);
+}
+
+static void ppi_teardown(void){
+  nrf_timer_TASK_STOP(1);
+  nrf_timer_TASK_STOP(2);
+  NRF_PPI_regs.CHENCLR = UINT32_MAX;
+  nrf_ppi_regw_sideeffects_CHENCLR();
+  for (int ch = 0; ch < 8; ch++) {
+    NRF_PPI_regs.CH[ch].EEP = 0;
+    nrf_ppi_regw_sideeffects_EEP(ch);
+    NRF_PPI_regs.CH[ch].TEP = 0;
+    nrf_ppi_regw_sideeffects_TEP(ch);
+  }
+}
+
+static void ppi_event_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    nrf_ppi_event(TIMER0_EVENTS_COMPARE_0);
+  }
+}
+
+/* As when the event comes from a peripheral timer handler */
+static void ppi_event_coalesced_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    nrf_ppi_coalesce_begin();
+    nrf_ppi_event(TIMER0_EVENTS_COMPARE_0);
+    nrf_ppi_coalesce_end();
+  }
+}
+
+/* Reprogram a channel event and task end points */
+static void ppi_reprogram_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    NRF_PPI_regs.CH[0].EEP = ADDR32(NRF_TIMER_regs[0].EVENTS_COMPARE[i & 3]);
+    nrf_ppi_regw_sideeffects_EEP(0);
+    NRF_PPI_regs.CH[0].TEP = ADDR32(NRF_TIMER_regs[1].TASKS_CAPTURE[i & 3]);
+    nrf_ppi_regw_sideeffects_TEP(0);
+  }
+}
+
+/*
+ * PPI TEP/EEP address lookups (as done in each channel reprogramming): with
+ * the hash tables, and with the linear search of the tables they replaced.
+ * The lookup hooks are in NRF_PPI.c, built with -D__TEST_PPI_ADDR_LOOKUP
+ */
+#define PPI_LOOKUP_N_ADDRS 4096
+#define PPI_LOOKUP_CHECK_N 1000000
+static void *ppi_lookup_teps[PPI_LOOKUP_N_ADDRS];
+static void *ppi_lookup_eeps[PPI_LOOKUP_N_ADDRS];
+
+static void ppi_lookup_setup(void){
+  nrf_ppi_test_random_addrs(ppi_lookup_teps, ppi_lookup_eeps, PPI_LOOKUP_N_ADDRS);
+}
+
+static void ppi_lookup_run(uint64_t n, bool linear){
+  volatile uintptr_t sink = 0;
+
+  for (uint64_t i = 0; i < n; i++) {
+    unsigned int j = i % PPI_LOOKUP_N_ADDRS;
+    sink += nrf_ppi_test_lookup(ppi_lookup_teps[j], ppi_lookup_eeps[j], linear);
+  }
+}
+
+static void ppi_lookup_hash_run(uint64_t n){
+  ppi_lookup_run(n, false);
+}
+
+static void ppi_lookup_linear_run(uint64_t n){
+  ppi_lookup_run(n, true);
+}
+
+/* Check: The hash lookups find the same as the linear search */
+static bool ppi_lookup_check(void){
+  for (unsigned int i = 0; i < PPI_LOOKUP_CHECK_N/PPI_LOOKUP_N_ADDRS; i++) {
+    ppi_lookup_setup();
+    for (unsigned int j = 0; j < PPI_LOOKUP_N_ADDRS; j++) {
+      if (!nrf_ppi_test_lookup_match(ppi_lookup_teps[j], ppi_lookup_eeps[j])) {
+        bs_trace_raw(3, "Lookup mismatch for TEP %p or EEP %p\n",
+                     ppi_lookup_teps[j], ppi_lookup_eeps[j]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * TIMER0 in timer mode at 1MHz
+ */
+static void timer_setup(void){
+  NRF_TIMER_regs[0].MODE = 0;
+  NRF_TIMER_regs[0].BITMODE = 3;
+  NRF_TIMER_regs[0].PRESCALER = 4;
+  nrf_timer_TASK_CLEAR(0);
+  nrf_timer_TASK_START(0);
+}
+
+/* Compare every 100us, cleared by the COMPARE0_CLEAR short */
+static void timer_compare_setup(void){
+  NRF_TIMER_regs[0].SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+  NRF_TIMER_regs[0].CC[0] = 100;
+  timer_setup();
+}
+
+static void timer_teardown(void){
+  nrf_timer_TASK_STOP(0);
+  NRF_TIMER_regs[0].SHORTS = 0;
+  NRF_TIMER_regs[0].CC[0] = 0;
+  NRF_TIMER_regs[0].EVENTS_COMPARE[0] = 0;
+  nrf_timer_regw_sideeffects_EVENTS_all(0);
+}
+
+/* Reprogram a compare value (which is not reached) */
+static void timer_cc_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    NRF_TIMER_regs[0].CC[0] = 1000000 + (i & 0xFFFF);
+    nrf_timer_regw_sideeffects_CC(0, 0);
+  }
+}
+
+static void timer_compare_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    bench_tm_run_until_event(&NRF_TIMER_regs[0].EVENTS_COMPARE[0], 200);
+    NRF_TIMER_regs[0].EVENTS_COMPARE[0] = 0;
+    nrf_timer_regw_sideeffects_EVENTS_all(0);
+  }
+}
+
+/*
+ * RTC0 at 32768Hz
+ */
+static void rtc_setup(void){
+  NRF_RTC_regs[0].PRESCALER = 0;
+  NRF_RTC_regs[0].TASKS_CLEAR = 1;
+  nrf_rtc_regw_sideeffect_TASKS_CLEAR(0);
+  NRF_RTC_regs[0].TASKS_START = 1;
+  nrf_rtc_regw_sideeffect_TASKS_START(0);
+}
+
+static void rtc_teardown(void){
+  NRF_RTC_regs[0].TASKS_STOP = 1;
+  nrf_rtc_regw_sideeffect_TASKS_STOP(0);
+  NRF_RTC_regs[0].CC[0] = 0;
+  NRF_RTC_regs[0].EVENTS_COMPARE[0] = 0;
+  nrf_rtc_regw_sideeffect_EVENTS_all(0);
+}
+
+/* Reprogram a compare value (which is not reached) */
+static void rtc_cc_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    NRF_RTC_regs[0].CC[0] = 0x100000 + (i & 0xFFFF);
+    nrf_rtc_regw_sideeffects_CC(0, 0);
+  }
+}
+
+/* Program a compare 2 ticks ahead, and wait for it */
+static void rtc_compare_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    nrf_rtc_update_COUNTER(0);
+    NRF_RTC_regs[0].CC[0] = (NRF_RTC_regs[0].COUNTER + 2) & 0xFFFFFF;
+    nrf_rtc_regw_sideeffects_CC(0, 0);
+    bench_tm_run_until_event(&NRF_RTC_regs[0].EVENTS_COMPARE[0], 200);
+    NRF_RTC_regs[0].EVENTS_COMPARE[0] = 0;
+    nrf_rtc_regw_sideeffect_EVENTS_all(0);
+  }
+}
+
+/*
+ * Interrupt controller: All interrupts enabled, in 8 priority levels
+ */
+static const unsigned int irq_pended[] = {RADIO_IRQn, TIMER0_IRQn, RTC1_IRQn, GPIOTE_IRQn};
+#define IRQ_N_PENDED (sizeof(irq_pended)/sizeof(irq_pended[0]))
+
+static void irq_setup(void){
+  for (unsigned int irq = 0; irq < NRF_HW_NBR_IRQs; irq++) {
+    hw_irq_ctrl_prio_set(irq, irq % 8);
+    hw_irq_ctrl_enable_irq(irq);
+  }
+}
+
+static void irq_teardown(void){
+  for (unsigned int irq = 0; irq < NRF_HW_NBR_IRQs; irq++) {
+    hw_irq_ctrl_disable_irq(irq);
+    hw_irq_ctrl_prio_set(irq, 255);
+  }
+  /* Let the IRQ controller timer run */
+  bench_tm_run_until(tm_get_hw_time());
+}
+
+/* Pend a few interrupts, and serve them in priority order as the CPU would */
+static void irq_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    int irq;
+
+    for (unsigned int j = 0; j < IRQ_N_PENDED; j++) {
+      hw_irq_ctrl_set_irq(irq_pended[j]);
+    }
+    while ((irq = hw_irq_ctrl_get_highest_prio_irq()) != -1) {
+      int last_prio = hw_irq_ctrl_get_cur_prio();
+
+      hw_irq_ctrl_set_cur_prio(hw_irq_ctrl_get_prio(irq));
+      hw_irq_ctrl_clear_irq(irq);
+      hw_irq_ctrl_set_cur_prio(last_prio);
+    }
+  }
+}
+
+/*
+ * RADIO: BLE 1Mbps packets, ramp up to end (DISABLED) using the
+ * READY_START and END_DISABLE shorts
+ */
+static uint8_t radio_packet[2 + 255]; /* S0, length & payload */
+static uint8_t phy_packet[2 + 255 + 3]; /* The same with the CRC */
+
+static void radio_setup(unsigned int len){
+  NRF_RADIO_regs.MODE = RADIO_MODE_MODE_Ble_1Mbit;
+  NRF_RADIO_regs.PCNF0 = (8 << RADIO_PCNF0_LFLEN_Pos)
+                         | (1 << RADIO_PCNF0_S0LEN_Pos)
+                         | (RADIO_PCNF0_PLEN_8bit << RADIO_PCNF0_PLEN_Pos);
+  NRF_RADIO_regs.PCNF1 = (255 << RADIO_PCNF1_MAXLEN_Pos)
+                         | (3 << RADIO_PCNF1_BALEN_Pos)
+                         | (RADIO_PCNF1_ENDIAN_Little << RADIO_PCNF1_ENDIAN_Pos)
+                         | (1 << RADIO_PCNF1_WHITEEN_Pos);
+  NRF_RADIO_regs.CRCCNF = (RADIO_CRCCNF_LEN_Three << RADIO_CRCCNF_LEN_Pos)
+                          | (RADIO_CRCCNF_SKIPADDR_Skip << RADIO_CRCCNF_SKIPADDR_Pos);
+  NRF_RADIO_regs.CRCPOLY = 0x00065B;
+  NRF_RADIO_regs.CRCINIT = BLE_CRC_INIT;
+  NRF_RADIO_regs.DATAWHITEIV = 37;
+  NRF_RADIO_regs.FREQUENCY = 2;
+  NRF_RADIO_regs.BASE0 = 0x89BED600;
+  NRF_RADIO_regs.PREFIX0 = 0x8E;
+  NRF_RADIO_regs.TXADDRESS = 0;
+  NRF_RADIO_regs.RXADDRESSES = 1;
+  NRF_RADIO_regs.PACKETPTR = ADDR32(radio_packet);
+  NRF_RADIO_regs.SHORTS = RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk;
+
+  radio_packet[0] = 0x02;
+  radio_packet[1] = len;
+  for (unsigned int i = 0; i < len; i++) {
+    radio_packet[2 + i] = i;
+  }
+  /* What the stub Phy will "receive" */
+  memcpy(phy_packet, radio_packet, 2 + len);
+  append_crc_ble(phy_packet, 2 + len, BLE_CRC_INIT);
+  bench_phy_set_rx_packet(phy_packet, 2 + len + 3);
+}
+
+static void radio_37_setup(void){
+  radio_setup(37);
+}
+
+static void radio_255_setup(void){
+  radio_setup(255);
+}
+
+static void radio_clear_events(void){
+  NRF_RADIO_regs.EVENTS_READY = 0;
+  NRF_RADIO_regs.EVENTS_TXREADY = 0;
+  NRF_RADIO_regs.EVENTS_RXREADY = 0;
+  NRF_RADIO_regs.EVENTS_ADDRESS = 0;
+  NRF_RADIO_regs.EVENTS_FRAMESTART = 0;
+  NRF_RADIO_regs.EVENTS_PAYLOAD = 0;
+  NRF_RADIO_regs.EVENTS_END = 0;
+  NRF_RADIO_regs.EVENTS_PHYEND = 0;
+  NRF_RADIO_regs.EVENTS_CRCOK = 0;
+  NRF_RADIO_regs.EVENTS_CRCERROR = 0;
+  NRF_RADIO_regs.EVENTS_DISABLED = 0;
+  nrf_radio_regw_sideeffects_EVENTS_all();
+}
+
+static void radio_teardown(void){
+  NRF_RADIO_regs.SHORTS = 0;
+  radio_clear_events();
+}
+
+static void radio_run(void (*enable_task)(void), uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    enable_task();
+    bench_tm_run_until_event(&NRF_RADIO_regs.EVENTS_DISABLED, 10000);
+    radio_clear_events();
+  }
+}
+
+static void radio_tx_run(uint64_t n){
+  radio_run(nrf_radio_tasks_TXEN, n);
+}
+
+static void radio_rx_run(uint64_t n){
+  radio_run(nrf_radio_tasks_RXEN, n);
+}
+
+/*
+ * Checks: The PPI fixed channel 24 (RADIO READY -> CCM KSGEN, and thru its
+ * ENDKSGEN_CRYPT short CRYPT) takes effect before the RADIO READY_START short
+ * starts the Tx/Rx, even if READY is raised inside a PPI coalescing window.
+ * (The stub libCryptov1.so "encrypts" by copying the payload, with a 0 MIC)
+ */
+#define CCM_CHECK_LEN 27
+#define CCM_CHECK_PPI_CH 24
+
+static uint8_t ccm_cnf[33]; /* Key, packet counter, direction & IV */
+static uint8_t ccm_in[3 + CCM_CHECK_LEN + 4]; /* S0, length, S1, payload & MIC */
+static uint8_t ccm_out[3 + CCM_CHECK_LEN + 4];
+static uint8_t ccm_scratch[43];
+static bool ccm_ksgen_at_rx_start;
+
+static void ccm_check_setup(uint32_t mode){
+  radio_setup(CCM_CHECK_LEN);
+  NRF_RADIO_regs.PCNF0 |= RADIO_PCNF0_S1INCL_Include << RADIO_PCNF0_S1INCL_Pos;
+  memset(ccm_in, 0, sizeof(ccm_in));
+  memset(ccm_out, 0xA5, sizeof(ccm_out));
+
+  NRF_CCM_regs.ENABLE = CCM_ENABLE_ENABLE_Enabled;
+  NRF_CCM_regs.MODE = mode << CCM_MODE_MODE_Pos;
+  NRF_CCM_regs.CNFPTR = ADDR32(ccm_cnf);
+  NRF_CCM_regs.INPTR = ADDR32(ccm_in);
+  NRF_CCM_regs.OUTPTR = ADDR32(ccm_out);
+  NRF_CCM_regs.SCRATCHPTR = ADDR32(ccm_scratch);
+  NRF_CCM_regs.HEADERMASK = 0xE3;
+  NRF_CCM_regs.SHORTS = CCM_SHORTS_ENDKSGEN_CRYPT_Msk;
+  NRF_PPI_regs.CHENSET = 1 << CCM_CHECK_PPI_CH;
+  nrf_ppi_regw_sideeffects_CHENSET();
+}
+
+static void ccm_check_teardown(void){
+  NRF_PPI_regs.CHENCLR = 1 << CCM_CHECK_PPI_CH;
+  nrf_ppi_regw_sideeffects_CHENCLR();
+  NRF_CCM_regs.SHORTS = 0;
+  NRF_CCM_regs.ENABLE = 0;
+  NRF_CCM_regs.EVENTS_ENDKSGEN = 0;
+  NRF_CCM_regs.EVENTS_ENDCRYPT = 0;
+  radio_teardown();
+}
+
+/* The packet on air is the one the CCM encrypted, not what was in OUTPTR before */
+static bool radio_ccm_tx_check(void){
+  const uint8_t *tx;
+  size_t tx_size;
+  bool ok;
+
+  ccm_check_setup(CCM_MODE_MODE_Encryption);
+  NRF_RADIO_regs.PACKETPTR = ADDR32(ccm_out);
+  ccm_in[0] = radio_packet[0];
+  ccm_in[1] = CCM_CHECK_LEN;
+  memcpy(&ccm_in[3], &radio_packet[2], CCM_CHECK_LEN);
+
+  nrf_radio_tasks_TXEN();
+  bench_tm_run_until_event(&NRF_RADIO_regs.EVENTS_DISABLED, 10000);
+
+  tx = bench_phy_get_tx_packet(&tx_size);
+  ok = NRF_CCM_regs.EVENTS_ENDCRYPT
+       && (tx_size == 2 + CCM_CHECK_LEN + 4 + 3)
+       && (tx[1] == CCM_CHECK_LEN + 4)
+       && (memcmp(&tx[2], &ccm_in[3], CCM_CHECK_LEN) == 0)
+       && (memcmp(&tx[2 + CCM_CHECK_LEN], "\0\0\0\0", 4) == 0);
+
+  ccm_check_teardown();
+  return ok;
+}
+
+static void ccm_rx_start_cb(void){
+  ccm_ksgen_at_rx_start = NRF_CCM_regs.EVENTS_ENDKSGEN;
+}
+
+/*
+ * The key stream is generated (and the decryption started) before the Rx
+ * starts (which, unlike the Tx, the READY_START short does synchronously),
+ * and the packet is decrypted
+ */
+static bool radio_ccm_rx_check(void){
+  bool ok;
+
+  ccm_check_setup(CCM_MODE_MODE_Decryption);
+  NRF_RADIO_regs.PACKETPTR = ADDR32(ccm_in);
+  phy_packet[1] = CCM_CHECK_LEN + 4;
+  memset(&phy_packet[2 + CCM_CHECK_LEN], 0, 4);
+  append_crc_ble(phy_packet, 2 + CCM_CHECK_LEN + 4, BLE_CRC_INIT);
+  bench_phy_set_rx_packet(phy_packet, 2 + CCM_CHECK_LEN + 4 + 3);
+  ccm_ksgen_at_rx_start = false;
+  bench_phy_set_rx_start_cb(ccm_rx_start_cb);
+
+  nrf_radio_tasks_RXEN();
+  bench_tm_run_until_event(&NRF_RADIO_regs.EVENTS_DISABLED, 10000);
+  bench_phy_set_rx_start_cb(NULL);
+
+  ok = ccm_ksgen_at_rx_start
+       && NRF_CCM_regs.EVENTS_ENDCRYPT
+       && (NRF_CCM_regs.MICSTATUS == 1)
+       && (ccm_out[1] == CCM_CHECK_LEN)
+       && (memcmp(&ccm_out[3], &radio_packet[2], CCM_CHECK_LEN) == 0);
+
+  ccm_check_teardown();
+  return ok;
+}
+
+/*
+ * CRC calculation of BLE and 802.15.4 packets
+ */
+static uint8_t crc_buf[2 + 255 + 3];
+
+static void crc_ble_37_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    append_crc_ble(crc_buf, 2 + 37, BLE_CRC_INIT);
+  }
+}
+
+static void crc_ble_255_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    append_crc_ble(crc_buf, 2 + 255, BLE_CRC_INIT);
+  }
+}
+
+static void crc_154_127_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    append_crc_154(crc_buf, 127 - 2, 0);
+  }
+}
+
+/*
+ * AAR: Resolve a private address which matches the last of 16 IRKs
+ */
+#define AAR_N_IRKS 16
+static uint8_t aar_irks[AAR_N_IRKS][16];
+static uint8_t aar_packet[3 + 6]; /* S0, length, S1 & the address */
+static uint8_t aar_scratch[3];
+
+static void aar_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    nrf_aar_TASK_START();
+    bench_tm_run_until_event(&NRF_AAR_regs.EVENTS_END, 1000);
+    NRF_AAR_regs.EVENTS_END = 0;
+    NRF_AAR_regs.EVENTS_RESOLVED = 0;
+    NRF_AAR_regs.EVENTS_NOTRESOLVED = 0;
+  }
+}
+
+static void aar_setup(void){
+  const uint8_t *irk = aar_irks[AAR_N_IRKS - 1];
+  uint32_t prand = 0x4A5A6B; /* 0b01 in the 2 MSBs: resolvable */
+  uint32_t hash;
+
+  for (int i = 0; i < AAR_N_IRKS; i++) {
+    for (int j = 0; j < 16; j++) {
+      aar_irks[i][j] = i * 17 + j;
+    }
+  }
+  /* The hash for the last IRK with the stub AES (key XOR data) */
+  hash = (irk[15] ^ (prand & 0xFF))
+         | (uint32_t)(irk[14] ^ ((prand >> 8) & 0xFF)) << 8
+         | (uint32_t)(irk[13] ^ ((prand >> 16) & 0xFF)) << 16;
+  for (int i = 0; i < 3; i++) {
+    aar_packet[3 + i] = hash >> (8*i);
+    aar_packet[6 + i] = prand >> (8*i);
+  }
+
+  NRF_AAR_regs.ENABLE = 3;
+  NRF_AAR_regs.NIRK = AAR_N_IRKS;
+  NRF_AAR_regs.IRKPTR = ADDR32(aar_irks);
+  NRF_AAR_regs.ADDRPTR = ADDR32(aar_packet);
+  NRF_AAR_regs.SCRATCHPTR = ADDR32(aar_scratch);
+
+  nrf_aar_TASK_START();
+  bench_tm_run_until_event(&NRF_AAR_regs.EVENTS_END, 1000);
+  if (NRF_AAR_regs.EVENTS_RESOLVED && (NRF_AAR_regs.STATUS != AAR_N_IRKS - 1)) {
+    bs_trace_warning_line("The AAR matched IRK %u instead of the last one, so it "
+                          "does not go thru all IRKs. Was the stub libCryptov1.so "
+                          "loaded?\n", NRF_AAR_regs.STATUS);
+  }
+  NRF_AAR_regs.EVENTS_END = 0;
+  NRF_AAR_regs.EVENTS_RESOLVED = 0;
+  NRF_AAR_regs.EVENTS_NOTRESOLVED = 0;
+}
+
+static void aar_teardown(void){
+  NRF_AAR_regs.ENABLE = 0;
+}
+
+/*
+ * NVMC: Write a word, and wait until the flash is ready again
+ */
+static void nvmc_setup(void){
+  NRF_NVMC_regs.CONFIG = NVMC_CONFIG_WEN_Wen;
+}
+
+static void nvmc_teardown(void){
+  NRF_NVMC_regs.CONFIG = NVMC_CONFIG_WEN_Ren;
+}
+
+static void nvmc_write_run(uint64_t n){
+  for (uint64_t i = 0; i < n; i++) {
+    nrfhw_nmvc_write_word((i * 4) % FLASH_PAGE_SIZE, (uint32_t)i);
+    bench_tm_run_until(tm_get_hw_time() + nrfhw_nvmc_time_to_ready());
+  }
+}
+
+const bench_case_t bench_cases[] = {
+  { "PPI_fanout/1",           ppi_fanout_1_setup,  ppi_event_run,           ppi_teardown },
+  { "PPI_fanout/8",           ppi_fanout_8_setup,  ppi_event_run,           ppi_teardown },
+  { "PPI_fanout_coalesced/8", ppi_fanout_8_setup,  ppi_event_coalesced_run, ppi_teardown },
+  { "PPI_reprogram",          NULL,                ppi_reprogram_run,       ppi_teardown },
+  { "PPI_lookup/hash",        ppi_lookup_setup,    ppi_lookup_hash_run,     NULL },
+  { "PPI_lookup/linear",      ppi_lookup_setup,    ppi_lookup_linear_run,   NULL },
+  { "TIMER_CC_write",         timer_setup,         timer_cc_run,            timer_teardown },
+  { "TIMER_compare",          timer_compare_setup, timer_compare_run,       timer_teardown },
+  { "RTC_CC_write",           rtc_setup,           rtc_cc_run,              rtc_teardown },
+  { "RTC_compare",            rtc_setup,           rtc_compare_run,         rtc_teardown },
+  { "IRQ_prio/4",             irq_setup,           irq_run,                 irq_teardown },
+  { "RADIO_Tx/37",            radio_37_setup,      radio_tx_run,            radio_teardown },
+  { "RADIO_Tx/255",           radio_255_setup,     radio_tx_run,            radio_teardown },
+  { "RADIO_Rx/37",            radio_37_setup,      radio_rx_run,            radio_teardown },
+  { "RADIO_Rx/255",           radio_255_setup,     radio_rx_run,            radio_teardown },
+  { "CRC_ble/37",             NULL,                crc_ble_37_run,          NULL },
+  { "CRC_ble/255",            NULL,                crc_ble_255_run,         NULL },
+  { "CRC_154/127",            NULL,                crc_154_127_run,         NULL },
+  { "AAR_resolve/16",         aar_setup,           aar_run,                 aar_teardown },
+  { "NVMC_write",             nvmc_setup,          nvmc_write_run,          nvmc_teardown },
+};
+
+const unsigned int bench_n_cases = sizeof(bench_cases)/sizeof(bench_cases[0]);
+
+const bench_check_t bench_checks[] = {
+  { "PPI_addr_lookup",        ppi_lookup_check },
+  { "RADIO_Tx_CCM",           radio_ccm_tx_check },
+  { "RADIO_Rx_CCM",           radio_ccm_rx_check },
+};
+
+const unsigned int bench_n_checks = sizeof(bench_checks)/sizeof(bench_checks[0]);
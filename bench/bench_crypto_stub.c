@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * libCryptov1 (BLECrypt) stub for the HW models benchmarks, loaded by
+ * BLECrypt_if.c in place of the real library.
+ *
+ * This is not cryptography: it only needs to be cheap and to give a
+ * different result for each key, so the AAR goes thru the IRKs until the
+ * right one (with the models built-in copy-thru every IRK would match).
+ */
+#include <stdint.h>
+#include <string.h>
+
+void blecrypt_aes_128(const uint8_t *key_be,
+                      const uint8_t *plaintext_data_be,
+                      uint8_t *encrypted_data_be){
+  for (int i = 0; i < 16; i++) {
+    encrypted_data_be[i] = key_be[i] ^ plaintext_data_be[i];
+  }
+}
+
+void blecrypt_packet_encrypt(uint8_t packet_1st_header_byte,
+                             uint8_t packet_payload_len,
+                             const uint8_t *packet_payload,
+                             const uint8_t *sk,
+                             const uint8_t *nonce,
+                             uint8_t *encrypted_packet_payload_and_mic){
+  memcpy(encrypted_packet_payload_and_mic, packet_payload, packet_payload_len);
+  memset(&encrypted_packet_payload_and_mic[packet_payload_len], 0, 4);
+}
+
+int blecrypt_packet_decrypt(uint8_t packet_1st_header_byte,
+                            uint8_t packet_payload_len,
+                            const uint8_t *packet_payload_and_mic,
+                            const uint8_t *sk,
+                            const uint8_t *nonce,
+                            int no_mic,
+                            uint8_t *decrypted_packet_payload){
+  memcpy(decrypted_packet_payload, packet_payload_and_mic, packet_payload_len);
+  return 1; /* MIC ok */
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Standalone microbenchmarks of the HW models
+ *
+ * bench_hw_models [-min_time=<s>] [-batch_dispatch] [-checks_only] [<filter>]
+ *
+ * First runs the functional checks (whose name contains <filter>), and, if
+ * they all pass, runs each case (whose name contains <filter>) for about
+ * <min_time> seconds, and reports the wall time per operation.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bs_cmd_line.h"
+#include "time_machine_if.h"
+#include "NRF_HW_model_top.h"
+#include "NRF_hw_args.h"
+#include "bench.h"
+
+/*
+ * What the integrating program (the board) would otherwise provide:
+ * There is no CPU to awake, no test ticker, and no command line for the models
+ */
+void posix_interrupt_raised(void){
+}
+
+void posix_irq_handler_im_from_sw(void){
+}
+
+void bst_tick(bs_time_t time){
+}
+
+void bs_add_extra_dynargs(bs_args_struct_t *args_struct_toadd){
+}
+
+static double min_time = 0.5;
+
+static double wall_time(void){
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static double bench_measure(const bench_case_t *c, uint64_t n){
+  double start = wall_time();
+
+  c->run(n);
+  return wall_time() - start;
+}
+
+static void bench_run_case(const bench_case_t *c){
+  uint64_t n = 1;
+  double elapsed;
+
+  if (c->setup) {
+    c->setup();
+  }
+  /* Find how many operations take about min_time */
+  while ((elapsed = bench_measure(c, n)) < min_time/10) {
+    n *= 10;
+  }
+  n = BS_MAX(1, (uint64_t)(n*min_time/elapsed));
+  elapsed = bench_measure(c, n);
+  if (c->teardown) {
+    c->teardown();
+  }
+
+  printf("%-24s %12.1f ns/op %12"PRIu64" ops\n", c->name, elapsed*1e9/n, n);
+  fflush(stdout);
+}
+
+static bool bench_run_check(const bench_check_t *c){
+  bool ok = c->run();
+
+  printf("%-24s %s\n", c->name, ok ? "PASSED" : "FAILED");
+  fflush(stdout);
+  return ok;
+}
+
+static bool bench_match(const char *name, const char *filter){
+  return (filter == NULL) || (strstr(name, filter) != NULL);
+}
+
+int main(int argc, char *argv[]){
+  static nrf_hw_sub_args_t args;
+  const char *filter = NULL;
+  bool batch_dispatch = false;
+  bool checks_only = false;
+  bool checks_ok = true;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "-min_time=", strlen("-min_time=")) == 0) {
+      min_time = atof(&argv[i][strlen("-min_time=")]);
+    } else if (strcmp(argv[i], "-batch_dispatch") == 0) {
+      batch_dispatch = true;
+    } else if (strcmp(argv[i], "-checks_only") == 0) {
+      checks_only = true;
+    } else if (argv[i][0] != '-') {
+      filter = argv[i];
+    } else {
+      fprintf(stderr, "Usage: %s [-min_time=<s>] [-batch_dispatch] [-checks_only] "
+              "[<filter>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bs_trace_register_time_function(tm_get_abs_time);
+  nrf_hw_pre_init();
+  nrf_hw_sub_cmline_set_defaults(&args);
+  args.batch_dispatch = batch_dispatch;
+  args.useRealAES = true; /* The stub libCryptov1.so, see bench_crypto_stub.c */
+  nrf_hw_initialize(&args);
+
+  for (unsigned int i = 0; i < bench_n_checks; i++) {
+    if (bench_match(bench_checks[i].name, filter)) {
+      checks_ok &= bench_run_check(&bench_checks[i]);
+    }
+  }
+  for (unsigned int i = 0; checks_ok && !checks_only && (i < bench_n_cases); i++) {
+    if (bench_match(bench_cases[i].name, filter)) {
+      bench_run_case(&bench_cases[i]);
+    }
+  }
+
+  nrf_hw_models_free_all();
+  return checks_ok ? 0 : 1;
+}
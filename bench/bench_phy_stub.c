@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * libPhyCom (2G4 device side) stub for the HW models benchmarks
+ *
+ * There is no Phy: every transmission succeeds (the last packet is kept for
+ * bench_phy_get_tx_packet()), and every reception finds right away, without
+ * errors, the packet set with bench_phy_set_rx_packet() (calling first the
+ * callback set with bench_phy_set_rx_start_cb(), if any).
+ * Abort reevaluations are not supported (the benchmarks do not use them).
+ */
+#include <string.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bs_pc_2G4.h"
+#include "bs_pc_2G4_utils.h"
+#include "bench.h"
+
+#define BENCH_PHY_MAX_PACKET 512
+
+static uint8_t rx_packet[BENCH_PHY_MAX_PACKET];
+static size_t rx_packet_size;
+static uint8_t tx_packet[BENCH_PHY_MAX_PACKET];
+static size_t tx_packet_size;
+static void (*rx_start_cb)(void);
+static p2G4_rxv2_done_t *rx_done;
+static unsigned int rx_bits_per_us;
+
+void bench_phy_set_rx_packet(const uint8_t *packet, size_t size){
+  if (size > BENCH_PHY_MAX_PACKET) {
+    bs_trace_error_line("Packet too big for the stub Phy (%zu > %i)\n",
+                        size, BENCH_PHY_MAX_PACKET);
+  }
+  memcpy(rx_packet, packet, size);
+  rx_packet_size = size;
+}
+
+/* Call <cb> (if not NULL) when the RADIO starts each reception */
+void bench_phy_set_rx_start_cb(void (*cb)(void)){
+  rx_start_cb = cb;
+}
+
+/* The last transmitted packet (header, payload & CRC) */
+const uint8_t *bench_phy_get_tx_packet(size_t *size){
+  *size = tx_packet_size;
+  return tx_packet;
+}
+
+int p2G4_dev_initcom_nc(uint d, const char* s, const char* p){
+  return 0;
+}
+
+void p2G4_dev_terminate_nc(void){
+}
+
+void p2G4_dev_disconnect_nc(void){
+}
+
+int p2G4_dev_req_wait_nc_b(pb_wait_t *wait_s){
+  return 0;
+}
+
+int p2G4_dev_req_txv2_nc_b(p2G4_txv2_t *tx_s, uint8_t *packet, p2G4_tx_done_t *tx_done_s){
+  tx_packet_size = BS_MIN(tx_s->packet_size, BENCH_PHY_MAX_PACKET);
+  memcpy(tx_packet, packet, tx_packet_size);
+  tx_done_s->end_time = tx_s->end_tx_time;
+  return P2G4_MSG_TX_END;
+}
+
+int p2G4_dev_req_rxv2_nc_b(p2G4_rxv2_t *rx_s, p2G4_address_t *phy_addr,
+                           p2G4_rxv2_done_t *rx_done_s, uint8_t **rx_buf, size_t buf_size){
+  size_t size = BS_MIN(rx_packet_size, buf_size);
+
+  if (rx_start_cb) {
+    rx_start_cb();
+  }
+  memset(rx_done_s, 0, sizeof(p2G4_rxv2_done_t));
+  rx_done_s->rx_time_stamp = rx_s->start_time + rx_s->pream_and_addr_duration;
+  rx_done_s->packet_size = size;
+  rx_done_s->status = P2G4_RXSTATUS_OK;
+  rx_done_s->rssi.RSSI = p2G4_RSSI_value_from_dBm(-60);
+  rx_done_s->phy_address = phy_addr[0];
+  memcpy(*rx_buf, rx_packet, size);
+
+  rx_done = rx_done_s;
+  rx_bits_per_us = (rx_s->radio_params.modulation == P2G4_MOD_BLE2M) ? 2 : 1;
+  return P2G4_MSG_RXV2_ADDRESSFOUND;
+}
+
+int p2G4_dev_rxv2_cont_after_addr_nc_b(bool accept_rx, p2G4_abort_t *abort){
+  if (!accept_rx) {
+    return 0;
+  }
+  rx_done->end_time = rx_done->rx_time_stamp
+                      + rx_done->packet_size*8/rx_bits_per_us;
+  return P2G4_MSG_RXV2_END;
+}
+
+int p2G4_dev_req_cca_nc_b(p2G4_cca_t *cca_s, p2G4_cca_done_t *cca_done_s){
+  bs_trace_error_line("CCA is not supported by the stub Phy\n");
+  return -1;
+}
+
+static int abort_not_supported(void){
+  bs_trace_error_line("Abort reevaluations are not supported by the stub Phy\n");
+  return -1;
+}
+
+int p2G4_dev_provide_new_tx_abort_nc_b(p2G4_abort_t *abort){
+  return abort_not_supported();
+}
+
+int p2G4_dev_provide_new_rxv2_abort_nc_b(p2G4_abort_t *abort){
+  return abort_not_supported();
+}
+
+int p2G4_dev_provide_new_cca_abort_nc_b(p2G4_abort_t *abort){
+  return abort_not_supported();
+}
+
+/*
+ * Same fixed point formats as libPhyCom
+ * (the values are only passed around, nothing is computed with them)
+ */
+double p2G4_RSSI_value_to_dBm(p2G4_rssi_power_t value){
+  return (double)(int32_t)value / (1 << 16);
+}
+
+p2G4_rssi_power_t p2G4_RSSI_value_from_dBm(double dBm){
+  return (p2G4_rssi_power_t)(int32_t)(dBm * (1 << 16));
+}
+
+p2G4_power_t p2G4_power_from_d(double value){
+  return (p2G4_power_t)(value * (1 << 8));
+}
+
+int p2G4_freq_from_d(double center_freq, int prox, p2G4_freq_t *result){
+  *result = (p2G4_freq_t)(center_freq * (1 << 8));
+  return 0;
+}
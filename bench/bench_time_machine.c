@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Time machine for the HW models benchmarks (see time_machine_if.h)
+ *
+ * There is no CPU or Phy to keep in sync: absolute, HW and Phy time are all
+ * the same, and time only advances when a benchmark case runs the HW models
+ * until something happens.
+ */
+#include <stdint.h>
+#include <inttypes.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "time_machine_if.h"
+#include "NRF_HW_model_top.h"
+#include "bench.h"
+
+static bs_time_t now;
+
+bs_time_t tm_get_abs_time(void){
+  return now;
+}
+
+bs_time_t tm_get_hw_time(void){
+  return now;
+}
+
+bs_time_t tm_abs_time_to_hw_time(bs_time_t abstime){
+  return abstime;
+}
+
+bs_time_t tm_hw_time_to_abs_time(bs_time_t hwtime){
+  return hwtime;
+}
+
+/* The HW models are the only source of events, their timer is read directly */
+void tm_find_next_timer_to_trigger(void){
+}
+
+bs_time_t tm_get_next_timer_abstime(void){
+  return timer_nrf_main_timer;
+}
+
+void tm_update_last_phy_sync_time(bs_time_t abs_time){
+}
+
+void tm_set_phy_max_resync_offset(bs_time_t offset_in_us){
+}
+
+/*
+ * Run the HW models until simulated time <end> (included)
+ */
+void bench_tm_run_until(bs_time_t end){
+  while (timer_nrf_main_timer <= end) {
+    now = timer_nrf_main_timer;
+    nrf_hw_some_timer_reached();
+  }
+  now = end;
+}
+
+/*
+ * Run the HW models until *<event> is set,
+ * which must happen in less than <timeout> microseconds
+ */
+void bench_tm_run_until_event(volatile uint32_t *event, bs_time_t timeout){
+  bs_time_t end = now + timeout;
+
+  while (*event == 0) {
+    if (timer_nrf_main_timer > end) {
+      bs_trace_error_line("The expected event did not occur in %"PRItime"us\n",
+                          timeout);
+    }
+    now = timer_nrf_main_timer;
+    nrf_hw_some_timer_reached();
+  }
+}
@@ -20,9 +20,10 @@
 #include <string.h>
 #include "bs_types.h"
 #include "bs_tracing.h"
+#include "NRF_HW_ctx.h"
 
-static bool Real_encryption_enabled = false;
-static void *LibCryptoHandle = NULL;
+static NRF_HW_STATE_LOCAL bool Real_encryption_enabled = false;
+static NRF_HW_STATE_LOCAL void *LibCryptoHandle = NULL;
 //Note that if this library IF is changed, this function prototypes need to be updated:
 //IF to the libCryptoBLE:
 typedef enum { SLAVE_TO_MASTER_DIRECTION, MASTER_TO_SLAVE_DIRECTION } blecrypt_packet_direction_t;
@@ -52,9 +53,9 @@ typedef void (*blecrypt_aes_128_f)(
     // Outputs (the pointers themselves are inputs and must point to large enough areas)
     uint8_t *encrypted_data_be);      // Plaintext data (KEY_LEN bytes, big-endian)
 
-static blecrypt_packet_encrypt_f blecrypt_packet_encrypt;
-static blecrypt_packet_decrypt_f blecrypt_packet_decrypt;
-static blecrypt_aes_128_f        blecrypt_aes_128;
+static NRF_HW_STATE_LOCAL blecrypt_packet_encrypt_f blecrypt_packet_encrypt;
+static NRF_HW_STATE_LOCAL blecrypt_packet_decrypt_f blecrypt_packet_decrypt;
+static NRF_HW_STATE_LOCAL blecrypt_aes_128_f        blecrypt_aes_128;
 
 void BLECrypt_if_enable_real_encryption(bool mode) {
   if ( mode ) { //if the user tries to enable it
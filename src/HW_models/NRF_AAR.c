@@ -17,16 +17,21 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
+#include "NRF_HW_trace.h"
 #include "BLECrypt_if.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_AAR = TIME_NEVER; /* Time when the AAR will finish */
+NRF_HW_STATE bs_time_t Timer_AAR = TIME_NEVER; /* Time when the AAR will finish */
+static NRF_HW_STATE nrf_hw_timer_handle_t AAR_timer;
 
-NRF_AAR_Type NRF_AAR_regs;
-static uint32_t AAR_INTEN = 0; //interrupt enable
-static bool AAR_Running;
-static int matching_irk;
+NRF_HW_STATE NRF_AAR_Type NRF_AAR_regs;
+static NRF_HW_STATE uint32_t AAR_INTEN = 0; //interrupt enable
+static NRF_HW_STATE bool AAR_Running;
+static NRF_HW_STATE int matching_irk;
 
 void nrf_aar_init(){
+  AAR_timer = nrf_hw_timer_register("AAR timer", NRF_HW_TIMER_PRIO_AAR, nrf_aar_timer_triggered);
+
   memset(&NRF_AAR_regs, 0, sizeof(NRF_AAR_regs));
   AAR_INTEN = 0;
   Timer_AAR = TIME_NEVER;
@@ -77,7 +82,7 @@ void nrf_aar_TASK_START(){
   n_irks = nrf_aar_resolve(&matching_irk);
 
   Timer_AAR = tm_get_hw_time() + 1 + 6 * n_irks; /*AAR delay*/
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(AAR_timer, Timer_AAR);
 }
 
 void nrf_aar_TASK_STOP(){
@@ -87,7 +92,7 @@ void nrf_aar_TASK_STOP(){
 
   AAR_Running = false;
   Timer_AAR = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(AAR_timer, Timer_AAR);
   signal_EVENTS_END();
   //Does this actually signal an END?
   //and only an END?
@@ -125,7 +130,7 @@ void nrf_aar_regw_sideeffects_TASKS_STOP(){
 void nrf_aar_timer_triggered(){
   AAR_Running = false;
   Timer_AAR = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(AAR_timer, Timer_AAR);
 
   if (matching_irk != -1) {
     NRF_AAR_regs.STATUS = matching_irk;
@@ -159,14 +164,14 @@ static int nrf_aar_resolve(int *good_irk) {
 
   *good_irk = -1;
 
-  bs_trace_raw_time(9,"HW AAR address to match %02x:%02x:%02x:%02x:%02x:%02x\n",
+  NRF_HW_TRACE_RAW_TIME(9,"HW AAR address to match %02x:%02x:%02x:%02x:%02x:%02x\n",
       address_ptr[5], address_ptr[4], address_ptr[3],
       address_ptr[2], address_ptr[1], address_ptr[0]);
 
   prand = *(uint32_t*)(address_ptr+3) & 0xFFFFFF;
   if (prand >> 22 != 0x01){
     /* Not a resolvable private address */
-    bs_trace_raw_time(7,"HW AAR the address is not resolvable (0x%06X , %x)\n", prand, prand >> 22);
+    NRF_HW_TRACE_RAW_TIME(7,"HW AAR the address is not resolvable (0x%06X , %x)\n", prand, prand >> 22);
     return NRF_AAR_regs.NIRK;
   }
 
@@ -192,15 +197,15 @@ static int nrf_aar_resolve(int *good_irk) {
 
     hash = *(uint32_t*)address_ptr & 0xFFFFFF;
 
-    bs_trace_raw_time(9,"HW AAR (%i): checking prand = 0x%06X, hash = 0x%06X, hashcheck = 0x%06X\n",i, prand, hash, hash_check);
+    NRF_HW_TRACE_RAW_TIME(9,"HW AAR (%i): checking prand = 0x%06X, hash = 0x%06X, hashcheck = 0x%06X\n",i, prand, hash, hash_check);
 
     if (hash == hash_check) {
-      bs_trace_raw_time(7,"HW AAR matched irk %i (of %i)\n",i, NRF_AAR_regs.NIRK);
+      NRF_HW_TRACE_RAW_TIME(7,"HW AAR matched irk %i (of %i)\n",i, NRF_AAR_regs.NIRK);
       *good_irk = i;
       return i+1;
     }
   }
 
-  bs_trace_raw_time(7,"HW AAR did not match any IRK of %i\n", NRF_AAR_regs.NIRK);
+  NRF_HW_TRACE_RAW_TIME(7,"HW AAR did not match any IRK of %i\n", NRF_AAR_regs.NIRK);
   return i;
 }
@@ -40,10 +40,11 @@
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
 #include "BLECrypt_if.h"
+#include "NRF_HW_ctx.h"
 
-NRF_CCM_Type NRF_CCM_regs;
-static uint32_t CCM_INTEN; //interrupt enable
-static bool decryption_ongoing;
+NRF_HW_STATE NRF_CCM_Type NRF_CCM_regs;
+static NRF_HW_STATE uint32_t CCM_INTEN; //interrupt enable
+static NRF_HW_STATE bool decryption_ongoing;
 
 void nrf_aes_ccm_init(){
   memset(&NRF_CCM_regs, 0, sizeof(NRF_CCM_regs));
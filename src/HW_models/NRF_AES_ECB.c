@@ -19,16 +19,18 @@
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
 #include "BLECrypt_if.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_ECB = TIME_NEVER; /* Time when the ECB will finish */
+NRF_HW_STATE bs_time_t Timer_ECB = TIME_NEVER; /* Time when the ECB will finish */
+static NRF_HW_STATE nrf_hw_timer_handle_t ECB_timer;
 
-NRF_ECB_Type NRF_ECB_regs;
+NRF_HW_STATE NRF_ECB_Type NRF_ECB_regs;
 
-static uint32_t ECB_INTEN; /* interrupt enable */
-static bool ECB_Running;
+static NRF_HW_STATE uint32_t ECB_INTEN; /* interrupt enable */
+static NRF_HW_STATE bool ECB_Running;
 
 #define DEFAULT_t_ECB 7
-static uint ECB_t_ECB = DEFAULT_t_ECB;
+static NRF_HW_STATE uint ECB_t_ECB = DEFAULT_t_ECB;
 
 typedef struct {
 	uint8_t KEY[16];        /* 16 byte AES key */
@@ -37,6 +39,8 @@ typedef struct {
 } ecbdata_t;
 
 void nrf_aes_ecb_init(){
+	ECB_timer = nrf_hw_timer_register("ECB timer", NRF_HW_TIMER_PRIO_ECB, nrf_ecb_timer_triggered);
+
 	memset(&NRF_ECB_regs, 0, sizeof(NRF_ECB_regs));
 	Timer_ECB = TIME_NEVER;
 	ECB_INTEN = 0;
@@ -89,14 +93,14 @@ void nrf_ecb_TASK_STOPECB(){
 
 	ECB_Running = false;
 	Timer_ECB = TIME_NEVER;
-	nrf_hw_find_next_timer_to_trigger();
+	nrf_hw_timer_update(ECB_timer, Timer_ECB);
 	signal_ERRORECB();
 }
 
 void nrf_ecb_TASK_STARTECB(){
 	ECB_Running = true;
 	Timer_ECB = tm_get_hw_time() + ECB_t_ECB;
-	nrf_hw_find_next_timer_to_trigger();
+	nrf_hw_timer_update(ECB_timer, Timer_ECB);
 }
 
 void nrf_ecb_regw_sideeffects_INTENSET(){
@@ -132,7 +136,7 @@ void nrf_ecb_timer_triggered(){
 
 	ECB_Running = false;
 	Timer_ECB = TIME_NEVER;
-	nrf_hw_find_next_timer_to_trigger();
+	nrf_hw_timer_update(ECB_timer, Timer_ECB);
 
 	ecbdata_t *ecbptr = (ecbdata_t *)NRF_ECB_regs.ECBDATAPTR;
 
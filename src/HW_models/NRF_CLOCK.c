@@ -47,32 +47,36 @@
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
 #include "bs_utils.h"
+#include "NRF_HW_ctx.h"
 
-NRF_CLOCK_Type NRF_CLOCK_regs;
-static uint32_t CLOCK_INTEN = 0; //interrupt enable
+NRF_HW_STATE NRF_CLOCK_Type NRF_CLOCK_regs;
+static NRF_HW_STATE uint32_t CLOCK_INTEN = 0; //interrupt enable
 
-bs_time_t Timer_CLOCK = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_CLOCK = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t CLOCK_timer;
 
-static bs_time_t Timer_CLOCK_LF = TIME_NEVER;
-static bs_time_t Timer_CLOCK_HF = TIME_NEVER;
-static bs_time_t Timer_LF_cal   = TIME_NEVER;
-static bs_time_t Timer_caltimer = TIME_NEVER;
+static NRF_HW_STATE bs_time_t Timer_CLOCK_LF = TIME_NEVER;
+static NRF_HW_STATE bs_time_t Timer_CLOCK_HF = TIME_NEVER;
+static NRF_HW_STATE bs_time_t Timer_LF_cal   = TIME_NEVER;
+static NRF_HW_STATE bs_time_t Timer_caltimer = TIME_NEVER;
 
 enum clock_states { Stopped, Starting, Started, Stopping};
-static enum clock_states HF_Clock_state = Stopped;
-static enum clock_states LF_Clock_state = Stopped;
-static enum clock_states LF_cal_state = Stopped;
-static enum clock_states caltimer_state = Stopped;
+static NRF_HW_STATE enum clock_states HF_Clock_state = Stopped;
+static NRF_HW_STATE enum clock_states LF_Clock_state = Stopped;
+static NRF_HW_STATE enum clock_states LF_cal_state = Stopped;
+static NRF_HW_STATE enum clock_states caltimer_state = Stopped;
 
 static void nrf_clock_update_master_timer(void) {
   bs_time_t t1 = BS_MIN(Timer_CLOCK_HF, Timer_CLOCK_LF);
   bs_time_t t2 = BS_MIN(Timer_LF_cal, Timer_caltimer);
   Timer_CLOCK = BS_MIN(t1, t2);
 
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(CLOCK_timer, Timer_CLOCK);
 }
 
 void nrf_clock_init(void) {
+  CLOCK_timer = nrf_hw_timer_register("CLOCK timer", NRF_HW_TIMER_PRIO_CLOCK, nrf_clock_timer_triggered);
+
   memset(&NRF_CLOCK_regs, 0, sizeof(NRF_CLOCK_regs));
   NRF_CLOCK_regs.HFXODEBOUNCE = 0x00000010;
 
@@ -91,7 +95,7 @@ void nrf_clock_clean_up(void) {
 }
 
 static void nrf_clock_eval_interrupt(void) {
-  static bool clock_int_line; /* Is the CLOCK currently driving its interrupt line high */
+  static NRF_HW_STATE bool clock_int_line; /* Is the CLOCK currently driving its interrupt line high */
   bool new_int_line = false;
 
 #define check_interrupt(x) \
@@ -107,13 +111,7 @@ static void nrf_clock_eval_interrupt(void) {
   check_interrupt(CTSTARTED);
   check_interrupt(CTSTOPPED);
 
-  if (clock_int_line == false && new_int_line == true) {
-    clock_int_line = true;
-    hw_irq_ctrl_raise_level_irq_line(POWER_CLOCK_IRQn);
-  } else if (clock_int_line == true && new_int_line == false) {
-    clock_int_line = false;
-    hw_irq_ctrl_lower_level_irq_line(POWER_CLOCK_IRQn);
-  }
+  hw_irq_ctrl_update_irq_lines(&clock_int_line, new_int_line, POWER_CLOCK_IRQn);
 }
 
 #define nrf_clock_event_handler(x) \
@@ -7,6 +7,7 @@
 #ifndef _NRF_HW_MODEL_EGU_H
 #define _NRF_HW_MODEL_EGU_H
 
+#include "bs_types.h"
 #include "nrfx.h"
 
 #ifdef __cplusplus
@@ -22,107 +23,27 @@ void nrf_egu_regw_sideeffect_EVENTS_TRIGGERED(int inst, uint event_nbr);
 void nrf_egu_regw_sideeffect_INTENSET(int inst);
 void nrf_egu_regw_sideeffect_INTENCLR(int inst);
 void nrf_egu_regw_sideeffect_INTEN(int inst);
-
+void nrf_egu_TASK_TRIGGER(int inst, int task_nbr);
 
 /*
- * Trampolines to automatically call from the PPI
+ * Description of the EGU tasks and events, from which the PPI tasks and
+ * events tables, and the EGU ppi_event_types_t are generated:
+ * NRF_EGU_FOR_EACH_TRIGGER(X) expands to X(inst, n) for each EGU instance <inst>
+ * and each of its TASKS_TRIGGER[n] & EVENTS_TRIGGERED[n]
  */
-void nrf_egu_0_TASK_TRIGGER_0(void);
-void nrf_egu_0_TASK_TRIGGER_1(void);
-void nrf_egu_0_TASK_TRIGGER_2(void);
-void nrf_egu_0_TASK_TRIGGER_3(void);
-void nrf_egu_0_TASK_TRIGGER_4(void);
-void nrf_egu_0_TASK_TRIGGER_5(void);
-void nrf_egu_0_TASK_TRIGGER_6(void);
-void nrf_egu_0_TASK_TRIGGER_7(void);
-void nrf_egu_0_TASK_TRIGGER_8(void);
-void nrf_egu_0_TASK_TRIGGER_9(void);
-void nrf_egu_0_TASK_TRIGGER_10(void);
-void nrf_egu_0_TASK_TRIGGER_11(void);
-void nrf_egu_0_TASK_TRIGGER_12(void);
-void nrf_egu_0_TASK_TRIGGER_13(void);
-void nrf_egu_0_TASK_TRIGGER_14(void);
-void nrf_egu_0_TASK_TRIGGER_15(void);
-void nrf_egu_1_TASK_TRIGGER_0(void);
-void nrf_egu_1_TASK_TRIGGER_1(void);
-void nrf_egu_1_TASK_TRIGGER_2(void);
-void nrf_egu_1_TASK_TRIGGER_3(void);
-void nrf_egu_1_TASK_TRIGGER_4(void);
-void nrf_egu_1_TASK_TRIGGER_5(void);
-void nrf_egu_1_TASK_TRIGGER_6(void);
-void nrf_egu_1_TASK_TRIGGER_7(void);
-void nrf_egu_1_TASK_TRIGGER_8(void);
-void nrf_egu_1_TASK_TRIGGER_9(void);
-void nrf_egu_1_TASK_TRIGGER_10(void);
-void nrf_egu_1_TASK_TRIGGER_11(void);
-void nrf_egu_1_TASK_TRIGGER_12(void);
-void nrf_egu_1_TASK_TRIGGER_13(void);
-void nrf_egu_1_TASK_TRIGGER_14(void);
-void nrf_egu_1_TASK_TRIGGER_15(void);
-void nrf_egu_2_TASK_TRIGGER_0(void);
-void nrf_egu_2_TASK_TRIGGER_1(void);
-void nrf_egu_2_TASK_TRIGGER_2(void);
-void nrf_egu_2_TASK_TRIGGER_3(void);
-void nrf_egu_2_TASK_TRIGGER_4(void);
-void nrf_egu_2_TASK_TRIGGER_5(void);
-void nrf_egu_2_TASK_TRIGGER_6(void);
-void nrf_egu_2_TASK_TRIGGER_7(void);
-void nrf_egu_2_TASK_TRIGGER_8(void);
-void nrf_egu_2_TASK_TRIGGER_9(void);
-void nrf_egu_2_TASK_TRIGGER_10(void);
-void nrf_egu_2_TASK_TRIGGER_11(void);
-void nrf_egu_2_TASK_TRIGGER_12(void);
-void nrf_egu_2_TASK_TRIGGER_13(void);
-void nrf_egu_2_TASK_TRIGGER_14(void);
-void nrf_egu_2_TASK_TRIGGER_15(void);
-void nrf_egu_3_TASK_TRIGGER_0(void);
-void nrf_egu_3_TASK_TRIGGER_1(void);
-void nrf_egu_3_TASK_TRIGGER_2(void);
-void nrf_egu_3_TASK_TRIGGER_3(void);
-void nrf_egu_3_TASK_TRIGGER_4(void);
-void nrf_egu_3_TASK_TRIGGER_5(void);
-void nrf_egu_3_TASK_TRIGGER_6(void);
-void nrf_egu_3_TASK_TRIGGER_7(void);
-void nrf_egu_3_TASK_TRIGGER_8(void);
-void nrf_egu_3_TASK_TRIGGER_9(void);
-void nrf_egu_3_TASK_TRIGGER_10(void);
-void nrf_egu_3_TASK_TRIGGER_11(void);
-void nrf_egu_3_TASK_TRIGGER_12(void);
-void nrf_egu_3_TASK_TRIGGER_13(void);
-void nrf_egu_3_TASK_TRIGGER_14(void);
-void nrf_egu_3_TASK_TRIGGER_15(void);
-void nrf_egu_4_TASK_TRIGGER_0(void);
-void nrf_egu_4_TASK_TRIGGER_1(void);
-void nrf_egu_4_TASK_TRIGGER_2(void);
-void nrf_egu_4_TASK_TRIGGER_3(void);
-void nrf_egu_4_TASK_TRIGGER_4(void);
-void nrf_egu_4_TASK_TRIGGER_5(void);
-void nrf_egu_4_TASK_TRIGGER_6(void);
-void nrf_egu_4_TASK_TRIGGER_7(void);
-void nrf_egu_4_TASK_TRIGGER_8(void);
-void nrf_egu_4_TASK_TRIGGER_9(void);
-void nrf_egu_4_TASK_TRIGGER_10(void);
-void nrf_egu_4_TASK_TRIGGER_11(void);
-void nrf_egu_4_TASK_TRIGGER_12(void);
-void nrf_egu_4_TASK_TRIGGER_13(void);
-void nrf_egu_4_TASK_TRIGGER_14(void);
-void nrf_egu_4_TASK_TRIGGER_15(void);
-void nrf_egu_5_TASK_TRIGGER_0(void);
-void nrf_egu_5_TASK_TRIGGER_1(void);
-void nrf_egu_5_TASK_TRIGGER_2(void);
-void nrf_egu_5_TASK_TRIGGER_3(void);
-void nrf_egu_5_TASK_TRIGGER_4(void);
-void nrf_egu_5_TASK_TRIGGER_5(void);
-void nrf_egu_5_TASK_TRIGGER_6(void);
-void nrf_egu_5_TASK_TRIGGER_7(void);
-void nrf_egu_5_TASK_TRIGGER_8(void);
-void nrf_egu_5_TASK_TRIGGER_9(void);
-void nrf_egu_5_TASK_TRIGGER_10(void);
-void nrf_egu_5_TASK_TRIGGER_11(void);
-void nrf_egu_5_TASK_TRIGGER_12(void);
-void nrf_egu_5_TASK_TRIGGER_13(void);
-void nrf_egu_5_TASK_TRIGGER_14(void);
-void nrf_egu_5_TASK_TRIGGER_15(void);
+#define NRF_EGU_FOR_EACH_TRIGGER(X) \
+  NRF_EGU_INST_TRIGGERS(X, 0) \
+  NRF_EGU_INST_TRIGGERS(X, 1) \
+  NRF_EGU_INST_TRIGGERS(X, 2) \
+  NRF_EGU_INST_TRIGGERS(X, 3) \
+  NRF_EGU_INST_TRIGGERS(X, 4) \
+  NRF_EGU_INST_TRIGGERS(X, 5)
+
+#define NRF_EGU_INST_TRIGGERS(X, inst) \
+  X(inst, 0)  X(inst, 1)  X(inst, 2)  X(inst, 3) \
+  X(inst, 4)  X(inst, 5)  X(inst, 6)  X(inst, 7) \
+  X(inst, 8)  X(inst, 9)  X(inst, 10) X(inst, 11) \
+  X(inst, 12) X(inst, 13) X(inst, 14) X(inst, 15)
 
 #ifdef __cplusplus
 }
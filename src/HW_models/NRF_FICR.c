@@ -21,8 +21,9 @@
 #include <string.h>
 #include "bs_rand_main.h"
 #include "weak_stubs.h"
+#include "NRF_HW_ctx.h"
 
-NRF_FICR_Type NRF_FICR_regs;
+NRF_HW_STATE NRF_FICR_Type NRF_FICR_regs;
 
 void nrf_ficr_init(){
   memset(&NRF_FICR_regs, 0xFF, sizeof(NRF_FICR_regs));
@@ -39,42 +39,43 @@
 #include "NRF_GPIO.h"
 #include "NRF_GPIOTE.h"
 #include "bs_tracing.h"
+#include "NRF_HW_ctx.h"
 
-NRF_GPIO_Type NRF_GPIO_regs[NRF_GPIOS];
+NRF_HW_STATE NRF_GPIO_Type NRF_GPIO_regs[NRF_GPIOS];
 
 /* Number of pins per port: */
 static int GPIO_n_ports_pins[NRF_GPIOS] = NRF_GPIO_PORTS_PINS;
 
-static uint32_t IO_level[NRF_GPIOS]; /* Actual level in the pin */
-static uint32_t DETECT[NRF_GPIOS];   /* Sense output / unlatched/non-sticky detect */
-static uint32_t LDETECT[NRF_GPIOS];  /* Latched sense output */
-static bool DETECT_signal[NRF_GPIOS]; /* Individual detect signal to the GPIOTE */
+static NRF_HW_STATE uint32_t IO_level[NRF_GPIOS]; /* Actual level in the pin */
+static NRF_HW_STATE uint32_t DETECT[NRF_GPIOS];   /* Sense output / unlatched/non-sticky detect */
+static NRF_HW_STATE uint32_t LDETECT[NRF_GPIOS];  /* Latched sense output */
+static NRF_HW_STATE bool DETECT_signal[NRF_GPIOS]; /* Individual detect signal to the GPIOTE */
 
-static uint32_t INPUT_mask[NRF_GPIOS]; /* As a 32bit mask, PIN_CNF[*].INPUT (0: enabled; 1: disabled)*/
-static uint32_t SENSE_mask[NRF_GPIOS]; /* As a 32bit mask, PIN_CNF[*].SENSE.en (1: enabled; 0: disabled)*/
-static uint32_t SENSE_inv[NRF_GPIOS];  /* As a 32bit mask, PIN_CNF[*].SENSE.inv (1: inverted;0: not inverted) */
+static NRF_HW_STATE uint32_t INPUT_mask[NRF_GPIOS]; /* As a 32bit mask, PIN_CNF[*].INPUT (0: enabled; 1: disabled)*/
+static NRF_HW_STATE uint32_t SENSE_mask[NRF_GPIOS]; /* As a 32bit mask, PIN_CNF[*].SENSE.en (1: enabled; 0: disabled)*/
+static NRF_HW_STATE uint32_t SENSE_inv[NRF_GPIOS];  /* As a 32bit mask, PIN_CNF[*].SENSE.inv (1: inverted;0: not inverted) */
 
 /*
  * Is the output driven by another peripheral (1) or the GPIO directly (0).
  * Note that we don't keep track of who "owns" a pin, only that somebody else does
  */
-static uint32_t out_override[NRF_GPIOS];
+static NRF_HW_STATE uint32_t out_override[NRF_GPIOS];
 /* Out value provided by other peripherals */
-static uint32_t external_OUT[NRF_GPIOS];
+static NRF_HW_STATE uint32_t external_OUT[NRF_GPIOS];
 
 /* Is the pin input controlled by a peripheral(1) or the GPIO(0) */
-static uint32_t input_override[NRF_GPIOS];
+static NRF_HW_STATE uint32_t input_override[NRF_GPIOS];
 /* If input_override, is the peripheral configuring the input buffer as connected (1) or disconnected (0) */
-static uint32_t input_override_connected[NRF_GPIOS];
+static NRF_HW_STATE uint32_t input_override_connected[NRF_GPIOS];
 
 /* Is "dir" controlled by a peripheral(1) or the GPIO(0) */
-static uint32_t dir_override[NRF_GPIOS];
+static NRF_HW_STATE uint32_t dir_override[NRF_GPIOS];
 /* If dir_override is set, is the peripheral configuring the output as connected (1) or disconnected (0) */
-static uint32_t dir_override_set[NRF_GPIOS];
+static NRF_HW_STATE uint32_t dir_override_set[NRF_GPIOS];
 
 /* Callbacks for peripherals to be informed of input changes */
-static nrf_gpio_input_callback_t per_intoggle_callbacks[NRF_GPIOS][NRF_GPIO_MAX_PINS_PER_PORT];
-static nrf_gpio_input_callback_t test_intoggle_callback;
+static NRF_HW_STATE_LOCAL nrf_gpio_input_callback_t per_intoggle_callbacks[NRF_GPIOS][NRF_GPIO_MAX_PINS_PER_PORT];
+static NRF_HW_STATE_LOCAL nrf_gpio_input_callback_t test_intoggle_callback;
 
 /*
  * Initialize the GPIOs model
@@ -396,7 +397,7 @@ static void nrf_gpio_output_change_sideeffects(unsigned int port,unsigned  int n
 static void nrf_gpio_eval_outputs(unsigned int port)
 {
 	/* Actual level in the pin, but only of the bits driven by output: */
-	static uint32_t O_level[NRF_GPIOS];
+	static NRF_HW_STATE uint32_t O_level[NRF_GPIOS];
 
 	uint32_t dir = get_dir(port); /* Which pins are driven by output */
 
@@ -21,14 +21,15 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
+#include "NRF_HW_ctx.h"
 
-NRF_GPIOTE_Type NRF_GPIOTE_regs = {0};
+NRF_HW_STATE NRF_GPIOTE_Type NRF_GPIOTE_regs = {0};
 
-static uint32_t GPIOTE_ITEN;
-static bool gpiote_int_line; /* Is the GPIOTE currently driving its interrupt line high */
+static NRF_HW_STATE uint32_t GPIOTE_ITEN;
+static NRF_HW_STATE bool gpiote_int_line; /* Is the GPIOTE currently driving its interrupt line high */
 
 /* For each GPIO channel, its status */
-static struct gpiote_ch_status_t {
+static NRF_HW_STATE struct gpiote_ch_status_t {
 	uint8_t mode;
 	uint8_t port;  /* GPIO instance */
 	uint8_t pin;   /* GPIO pin in that instance (psel) */
@@ -130,13 +131,7 @@ static void nrf_gpiote_eval_interrupt(void) {
 		new_int_line = true;
 	}
 
-	if (gpiote_int_line == false && new_int_line == true) {
-		gpiote_int_line = true;
-		hw_irq_ctrl_raise_level_irq_line(GPIOTE_IRQn);
-	} else if (gpiote_int_line == true && new_int_line == false) {
-		gpiote_int_line = false;
-		hw_irq_ctrl_lower_level_irq_line(GPIOTE_IRQn);
-	}
+	hw_irq_ctrl_update_irq_lines(&gpiote_int_line, new_int_line, GPIOTE_IRQn);
 }
 
 static void nrf_gpiote_events_in(unsigned int n) {
@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include "NRF_GPIO.h"
 #include "bs_types.h"
@@ -23,8 +24,11 @@
 #include "bs_tracing.h"
 #include "bs_oswrap.h"
 #include "bs_compat.h"
+#include "NRF_HW_ctx.h"
+#include "NRF_HW_snapshot.h"
 
-bs_time_t Timer_GPIO_input = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_GPIO_input = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t GPIO_input;
 
 char *gpio_in_file_path = NULL; /* Possible file for input stimuli */
 char *gpio_out_file_path = NULL; /* Possible file for dumping output toggles */
@@ -34,15 +38,15 @@ char *gpio_conf_file_path = NULL; /* Possible file for configuration (short-circ
 #define MAX_SHORTS 8
 
 /* Table keeping all configured short-circuits */
-static struct {
+static NRF_HW_STATE struct {
 	uint8_t port;
 	uint8_t pin;
 } shorts[NRF_GPIOS][NRF_GPIO_MAX_PINS_PER_PORT][MAX_SHORTS];
 
-static FILE *output_file_ptr; /* File pointer for gpio_out_file_path */
+static NRF_HW_STATE_LOCAL FILE *output_file_ptr; /* File pointer for gpio_out_file_path */
 
 /* GPIO input status */
-static struct {
+static NRF_HW_STATE_LOCAL struct {
 	FILE *input_file_ptr; /* File pointer for gpio_out_file_path */
 	/* Next event port.pin & level: */
 	unsigned int port;
@@ -50,6 +54,8 @@ static struct {
 	bool level;           /* true: high; false: low*/
 } gpio_input_file_st;
 
+static NRF_HW_STATE_LOCAL long gpio_input_fanout_pos; /* Input file position at the fan-out */
+
 static void nrf_gpio_load_config(void);
 static void nrf_gpio_init_output_file(void);
 static void nrf_gpio_init_input_file(void);
@@ -59,6 +65,9 @@ static void nrf_gpio_init_input_file(void);
  */
 void nrf_gpio_backend_init(void)
 {
+	GPIO_input = nrf_hw_timer_register("GPIO input timer", NRF_HW_TIMER_PRIO_GPIO_INPUT,
+					   nrf_gpio_input_event_triggered);
+
 	memset(shorts, UINT8_MAX, sizeof(shorts));
 
 	nrf_gpio_load_config();
@@ -329,20 +338,15 @@ static void nrf_gpio_input_process_next_time(char *buf)
 		Timer_GPIO_input = time;
 	}
 
-	nrf_hw_find_next_timer_to_trigger();
+	nrf_hw_timer_update(GPIO_input, Timer_GPIO_input);
 }
 
 /*
- * Initialize GPIO input from file, and queue next input event change
+ * Open the GPIO input file, and queue its first input event change
+ * (if <skip_past> is set, the events before the current time are skipped)
  */
-static void nrf_gpio_init_input_file(void)
+static void nrf_gpio_open_input_file(bool skip_past)
 {
-	gpio_input_file_st.input_file_ptr = NULL;
-
-	if (gpio_in_file_path == NULL) {
-		return;
-	}
-
 	char line_buf[MAXLINESIZE];
 	int read;
 
@@ -356,10 +360,118 @@ static void nrf_gpio_init_input_file(void)
 		bs_trace_warning_line("%s: Input file %s seems empty\n",
 				      __func__, gpio_in_file_path);
 	}
+	if (skip_past) {
+		bs_time_t time;
+
+		while ((read > 0) && (sscanf(line_buf, "%"SCNtime, &time) == 1)
+		       && (time < tm_get_abs_time())) {
+			read = readline(line_buf, MAXLINESIZE, gpio_input_file_st.input_file_ptr);
+		}
+	}
 
 	nrf_gpio_input_process_next_time(line_buf);
 }
 
+/*
+ * Initialize GPIO input from file, and queue next input event change
+ */
+static void nrf_gpio_init_input_file(void)
+{
+	gpio_input_file_st.input_file_ptr = NULL;
+
+	if (gpio_in_file_path == NULL) {
+		return;
+	}
+
+	nrf_gpio_open_input_file(false);
+}
+
+/*
+ * Save/restore into/from a snapshot the position in the input file
+ * (the input file must be the same when restoring)
+ */
+void nrf_gpio_backend_snapshot_save(int fd)
+{
+	int64_t offset = -1;
+
+	if (gpio_input_file_st.input_file_ptr != NULL) {
+		offset = ftell(gpio_input_file_st.input_file_ptr);
+	}
+	nrf_hw_snapshot_write(fd, &offset, sizeof(offset));
+	nrf_hw_snapshot_write(fd, &gpio_input_file_st.port, sizeof(gpio_input_file_st.port));
+	nrf_hw_snapshot_write(fd, &gpio_input_file_st.pin, sizeof(gpio_input_file_st.pin));
+	nrf_hw_snapshot_write(fd, &gpio_input_file_st.level, sizeof(gpio_input_file_st.level));
+}
+
+void nrf_gpio_backend_snapshot_restore(int fd)
+{
+	int64_t offset;
+
+	nrf_hw_snapshot_read(fd, &offset, sizeof(offset));
+	nrf_hw_snapshot_read(fd, &gpio_input_file_st.port, sizeof(gpio_input_file_st.port));
+	nrf_hw_snapshot_read(fd, &gpio_input_file_st.pin, sizeof(gpio_input_file_st.pin));
+	nrf_hw_snapshot_read(fd, &gpio_input_file_st.level, sizeof(gpio_input_file_st.level));
+
+	if ((offset >= 0) != (gpio_input_file_st.input_file_ptr != NULL)) {
+		bs_trace_error_line("%s: The GPIO input file must be used (or not) both when "
+				    "saving and restoring a snapshot\n", __func__);
+	}
+	if ((offset >= 0) && (fseek(gpio_input_file_st.input_file_ptr, offset, SEEK_SET) != 0)) {
+		bs_trace_error_line("%s: Could not seek in the GPIO input file %s\n",
+				    __func__, gpio_in_file_path);
+	}
+}
+
+/*
+ * Before forking the fan-out children (see NRF_HW_fanout.h):
+ * Close the GPIO files, as otherwise all children would share their file offsets.
+ * (The parent process does not continue the simulation)
+ */
+void nrf_gpio_backend_fanout_prepare(void)
+{
+	if (output_file_ptr != NULL) {
+		fclose(output_file_ptr);
+		output_file_ptr = NULL;
+	}
+
+	gpio_input_fanout_pos = -1;
+	if (gpio_input_file_st.input_file_ptr != NULL) {
+		gpio_input_fanout_pos = ftell(gpio_input_file_st.input_file_ptr);
+		fclose(gpio_input_file_st.input_file_ptr);
+		gpio_input_file_st.input_file_ptr = NULL;
+	}
+}
+
+/*
+ * In a fan-out child: Reopen the GPIO files.
+ * The output is recorded in <gpio_out_file>.<child>
+ * If <in_file_path> is set, the inputs are driven from that file from now on
+ * (skipping its events before the current time), otherwise the original input
+ * file continues from where it was.
+ */
+void nrf_gpio_backend_fanout_child(unsigned int child, char *in_file_path)
+{
+	if (gpio_out_file_path != NULL) {
+		char *path = bs_malloc(strlen(gpio_out_file_path) + 12);
+
+		sprintf(path, "%s.%u", gpio_out_file_path, child);
+		output_file_ptr = bs_fopen(path, "w");
+		fprintf(output_file_ptr, "time(microsecond),port,pin,level\n");
+		free(path);
+	}
+
+	if (in_file_path != NULL) {
+		gpio_in_file_path = in_file_path;
+		nrf_gpio_open_input_file(true);
+	} else if (gpio_input_fanout_pos >= 0) {
+		gpio_input_file_st.input_file_ptr = bs_fopen(gpio_in_file_path, "r");
+		if (fseek(gpio_input_file_st.input_file_ptr, gpio_input_fanout_pos, SEEK_SET) != 0) {
+			bs_trace_error_line("%s: Could not seek in the GPIO input file %s\n",
+					    __func__, gpio_in_file_path);
+		}
+	}
+}
+
 /*
  * Event timer handler for the GPIO input
  */
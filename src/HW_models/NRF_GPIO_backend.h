@@ -21,6 +21,12 @@ void nrf_gpio_backend_register_short(uint8_t X, uint8_t x, uint8_t Y, uint8_t y)
 
 void nrf_gpio_input_event_triggered(void);
 
+void nrf_gpio_backend_snapshot_save(int fd);
+void nrf_gpio_backend_snapshot_restore(int fd);
+
+void nrf_gpio_backend_fanout_prepare(void);
+void nrf_gpio_backend_fanout_child(unsigned int child, char *in_file_path);
+
 #ifdef __cplusplus
 }
 #endif
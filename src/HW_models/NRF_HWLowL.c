@@ -24,6 +24,10 @@ void hwll_set_nosim(bool new_nosim){
   nosim = new_nosim;
 }
 
+bool hwll_get_nosim(void){
+  return nosim;
+}
+
 /**
  * Return the equivalent phy time from a device time
  */
@@ -74,7 +78,7 @@ void hwll_sync_time_with_phy(bs_time_t d_time) {
     wait.end = TIME_NEVER;
   }
 
-  if ( p2G4_dev_req_wait_nc_b(&wait) != 0){
+  if ( hwll_req_wait(&wait) != 0){
     bs_trace_raw_manual_time(3, d_time, "The phy disconnected us\n");
     hwll_disconnect_phy_and_exit();
   }
@@ -94,7 +98,7 @@ void hwll_wait_for_phy_simu_time(bs_time_t phy_time){
 
   wait.end = phy_time;
 
-  if ( p2G4_dev_req_wait_nc_b(&wait) != 0 ){
+  if ( hwll_req_wait(&wait) != 0 ){
     bs_trace_raw_manual_time(3, phy_time, "The phy disconnected us\n");
     hwll_disconnect_phy_and_exit();
   }
@@ -104,7 +108,7 @@ void hwll_wait_for_phy_simu_time(bs_time_t phy_time){
  * Connect to the phy
  */
 int hwll_connect_to_phy(uint d, const char* s, const char* p){
-  if (!nosim) {
+  if (!nosim && !hwll_rr_replaying()) {
     return p2G4_dev_initcom_nc(d, s, p);
   } else {
     return 0;
@@ -115,7 +119,7 @@ int hwll_connect_to_phy(uint d, const char* s, const char* p){
  * Disconnect from the phy, and ask it to end the simulation
  */
 void hwll_terminate_simulation(){
-  if (!nosim) {
+  if (!nosim && !hwll_rr_replaying()) {
     p2G4_dev_terminate_nc();
   }
 }
@@ -124,7 +128,7 @@ void hwll_terminate_simulation(){
  * Disconnect from the phy, but let the simulation continue without us
  */
 void hwll_disconnect_phy(){
-  if (!nosim) {
+  if (!nosim && !hwll_rr_replaying()) {
     p2G4_dev_disconnect_nc();
   }
 }
@@ -11,6 +11,7 @@
 #define _NRF_HWLOWL_H
 
 #include "bs_types.h"
+#include "bs_pc_2G4_types.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -21,6 +22,7 @@ void hwll_disconnect_phy();
 void hwll_disconnect_phy_and_exit();
 void hwll_terminate_simulation();
 void hwll_set_nosim(bool new_nosim);
+bool hwll_get_nosim(void);
 
 bs_time_t hwll_phy_time_from_dev(bs_time_t d_t);
 bs_time_t hwll_dev_time_from_phy(bs_time_t phy_t);
@@ -28,6 +30,24 @@ bs_time_t hwll_dev_time_from_phy(bs_time_t phy_t);
 void hwll_sync_time_with_phy(bs_time_t d_t);
 void hwll_wait_for_phy_simu_time(bs_time_t phy_time);
 
+/*
+ * Requests to the Phy (see NRF_HWLowL_rr.c)
+ * Same as libPhyCom p2G4_dev_*_nc_b() functions, but can be recorded or replayed
+ */
+void hwll_rr_pre_init(void);
+void hwll_rr_clean_up(void);
+bool hwll_rr_replaying(void);
+int hwll_req_wait(pb_wait_t *wait_s);
+uint8_t *hwll_tx_packet_buf(size_t size);
+int hwll_req_txv2(p2G4_txv2_t *tx_s, uint8_t *packet, p2G4_tx_done_t *tx_done_s);
+int hwll_provide_new_tx_abort(p2G4_abort_t *abort);
+int hwll_req_rxv2(p2G4_rxv2_t *rx_s, p2G4_address_t *phy_addr,
+                  p2G4_rxv2_done_t *rx_done_s, uint8_t **rx_buf, size_t buf_size);
+int hwll_provide_new_rxv2_abort(p2G4_abort_t *abort);
+int hwll_rxv2_cont_after_addr(bool accept_rx, p2G4_abort_t *abort);
+int hwll_req_cca(p2G4_cca_t *cca_s, p2G4_cca_done_t *cca_done_s);
+int hwll_provide_new_cca_abort(p2G4_abort_t *abort);
+
 #ifdef __cplusplus
 }
 #endif
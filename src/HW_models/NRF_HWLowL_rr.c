@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Record and replay of the device interactions with the Phy
+ *
+ * All requests to the Phy go thru the hwll_req_*() & hwll_provide_*() functions
+ * in this file, which forward them to libPhyCom, and optionally:
+ *
+ *  -phy_record=<file>: Record each request and the Phy response in <file>
+ *  -phy_replay=<file>: Do not connect to a Phy, but serve each request with the
+ *       response recorded in <file>. Each request is compared with the recorded
+ *       one, and if they differ (the device diverged from the recording)
+ *       the simulation is stopped reporting the first mismatching request.
+ *
+ * File format (host endianness, only meant to be read by the same executable):
+ *   "NRFPHYR1"
+ *   For each request:
+ *     rr_record_header_t
+ *     The request (<req_size> bytes: The request structure followed by,
+ *                  for a Tx, the packet, for an Rx, the addresses)
+ *     The response (<resp_size> bytes: The response structure followed by,
+ *                   for an Rx with an address found, the received packet)
+ *
+ * The requests in flight, buffers and open file are per device (context, see
+ * NRF_HW_ctx.h), while the mode and paths are process wide (command line).
+ * As there is only one Phy link per process, only one device may record or
+ * replay its Phy interactions.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bs_oswrap.h"
+#include "bs_utils.h"
+#include "bs_cmd_line.h"
+#include "bs_compat.h"
+#include "bs_pc_2G4.h"
+#include "NRF_HWLowL.h"
+#include "time_machine_if.h"
+#include "weak_stubs.h"
+#include "NRF_HW_ctx.h"
+
+#define RR_MAGIC "NRFPHYR1"
+
+typedef enum {
+  RR_WAIT = 0,
+  RR_TX,
+  RR_TX_ABORT,
+  RR_RX,
+  RR_RX_ABORT,
+  RR_RX_CONT,
+  RR_CCA,
+  RR_CCA_ABORT,
+  RR_NUMBER
+} rr_type_t;
+
+static const char *rr_type_names[RR_NUMBER] = {
+  "wait", "Tx", "Tx abort reevaluation", "Rx", "Rx abort reevaluation",
+  "Rx continue after address", "CCA", "CCA abort reevaluation"
+};
+
+typedef struct {
+  uint8_t type;
+  uint8_t reserved[3];
+  int32_t ret;
+  bs_time_t time; /* Device time of the request */
+  uint32_t req_size;
+  uint32_t resp_size;
+} rr_record_header_t;
+
+static enum {RR_OFF = 0, RR_RECORD, RR_REPLAY} rr_mode;
+static char *rr_record_path;
+static char *rr_replay_path;
+/* Context (device) which has the record/replay file open, if any */
+static nrf_hw_ctx_t *rr_file_ctx;
+
+static NRF_HW_STATE_LOCAL FILE *rr_file;
+static NRF_HW_STATE_LOCAL uint64_t rr_n_requests;
+
+/* Serialized request and response being handled */
+static NRF_HW_STATE_LOCAL uint8_t *rr_req;
+static NRF_HW_STATE_LOCAL size_t rr_req_len, rr_req_alloc;
+static NRF_HW_STATE_LOCAL uint8_t *rr_resp;
+static NRF_HW_STATE_LOCAL size_t rr_resp_len, rr_resp_alloc;
+/* Recorded request (in replay mode) */
+static NRF_HW_STATE_LOCAL uint8_t *rr_rec_req;
+static NRF_HW_STATE_LOCAL size_t rr_rec_req_alloc;
+
+/* Where libPhyCom returns the responses for the ongoing Tx, Rx & CCA */
+static NRF_HW_STATE_LOCAL p2G4_tx_done_t *rr_tx_done;
+static NRF_HW_STATE_LOCAL p2G4_rxv2_done_t *rr_rx_done;
+static NRF_HW_STATE_LOCAL uint8_t **rr_rx_buf;
+static NRF_HW_STATE_LOCAL size_t rr_rx_buf_size;
+static NRF_HW_STATE_LOCAL p2G4_cca_done_t *rr_cca_done;
+
+/* Packet assembled in place for the next Tx request (see hwll_tx_packet_buf()) */
+static NRF_HW_STATE_LOCAL uint8_t *rr_tx_packet;
+
+static void rr_buf_add(uint8_t **buf, size_t *len, size_t *alloc,
+                       const void *data, size_t size){
+  if (*len + size > *alloc) {
+    *alloc = BS_MAX(*len + size, 2 * *alloc);
+    *buf = bs_realloc(*buf, *alloc);
+  }
+  memcpy(*buf + *len, data, size);
+  *len += size;
+}
+
+static void rr_req_add(const void *data, size_t size){
+  rr_buf_add(&rr_req, &rr_req_len, &rr_req_alloc, data, size);
+}
+
+static void rr_resp_add(const void *data, size_t size){
+  rr_buf_add(&rr_resp, &rr_resp_len, &rr_resp_alloc, data, size);
+}
+
+static void rr_fread(void *buf, size_t size){
+  if ((size > 0) && (fread(buf, size, 1, rr_file) != 1)) {
+    bs_trace_error_time_line("Phy replay: file %s ended at request %"PRIu64", "
+                             "the device did more requests than were recorded\n",
+                             rr_replay_path, rr_n_requests);
+  }
+}
+
+static void rr_fwrite(const void *buf, size_t size){
+  if ((size > 0) && (fwrite(buf, size, 1, rr_file) != 1)) {
+    bs_trace_error_line("Phy record: failed to write to %s\n", rr_record_path);
+  }
+}
+
+static void rr_open(void){
+  char magic[sizeof(RR_MAGIC) - 1];
+
+  if ((rr_mode == RR_OFF) || (rr_file != NULL)) {
+    return;
+  }
+  if (rr_file_ctx != NULL) {
+    bs_trace_error_line("Phy %s: only one device per process can use the Phy\n",
+                        rr_mode == RR_RECORD ? "record" : "replay");
+  }
+  rr_file_ctx = nrf_hw_ctx_get_active();
+  if (rr_mode == RR_RECORD) {
+    _bs_create_folders_in_path(rr_record_path);
+    rr_file = bs_fopen(rr_record_path, "w");
+    rr_fwrite(RR_MAGIC, sizeof(magic));
+  } else {
+    rr_file = bs_fopen(rr_replay_path, "r");
+    if ((fread(magic, sizeof(magic), 1, rr_file) != 1)
+        || (memcmp(magic, RR_MAGIC, sizeof(magic)) != 0)) {
+      bs_trace_error_line("Phy replay: %s is not a Phy recording\n", rr_replay_path);
+    }
+  }
+}
+
+/*
+ * Collect the response libPhyCom provided to the last request
+ */
+static void rr_resp_collect(rr_type_t type, int ret){
+  rr_resp_len = 0;
+
+  switch (type) {
+    case RR_TX:
+    case RR_TX_ABORT:
+      rr_resp_add(rr_tx_done, sizeof(p2G4_tx_done_t));
+      break;
+    case RR_RX:
+    case RR_RX_ABORT:
+    case RR_RX_CONT:
+      rr_resp_add(rr_rx_done, sizeof(p2G4_rxv2_done_t));
+      if (ret == P2G4_MSG_RXV2_ADDRESSFOUND) {
+        rr_resp_add(*rr_rx_buf, BS_MIN(rr_rx_done->packet_size, rr_rx_buf_size));
+      }
+      break;
+    case RR_CCA:
+    case RR_CCA_ABORT:
+      rr_resp_add(rr_cca_done, sizeof(p2G4_cca_done_t));
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * Provide to the radio the recorded response, as libPhyCom would have
+ */
+static void rr_resp_apply(rr_type_t type, int ret){
+  size_t expected = 0;
+  void *dest = NULL;
+
+  switch (type) {
+    case RR_TX:
+    case RR_TX_ABORT:
+      dest = rr_tx_done;
+      expected = sizeof(p2G4_tx_done_t);
+      break;
+    case RR_RX:
+    case RR_RX_ABORT:
+    case RR_RX_CONT:
+      dest = rr_rx_done;
+      expected = sizeof(p2G4_rxv2_done_t);
+      break;
+    case RR_CCA:
+    case RR_CCA_ABORT:
+      dest = rr_cca_done;
+      expected = sizeof(p2G4_cca_done_t);
+      break;
+    default:
+      break;
+  }
+
+  if ((rr_resp_len < expected)
+      || ((rr_resp_len > expected) && (ret != P2G4_MSG_RXV2_ADDRESSFOUND))) {
+    bs_trace_error_time_line("Phy replay: corrupted response in request %"PRIu64"\n",
+                             rr_n_requests);
+  }
+  if (expected > 0) {
+    memcpy(dest, rr_resp, expected);
+  }
+  if (rr_resp_len > expected) {
+    memcpy(*rr_rx_buf, rr_resp + expected, BS_MIN(rr_resp_len - expected, rr_rx_buf_size));
+  }
+}
+
+static void rr_record(rr_type_t type, bs_time_t time, int ret){
+  rr_record_header_t header;
+
+  rr_open();
+  rr_resp_collect(type, ret);
+
+  memset(&header, 0, sizeof(header));
+  header.type = type;
+  header.ret = ret;
+  header.time = time;
+  header.req_size = rr_req_len;
+  header.resp_size = rr_resp_len;
+
+  rr_fwrite(&header, sizeof(header));
+  rr_fwrite(rr_req, rr_req_len);
+  rr_fwrite(rr_resp, rr_resp_len);
+  rr_n_requests++;
+}
+
+static int rr_replay(rr_type_t type){
+  rr_record_header_t header;
+  bs_time_t now = tm_get_abs_time();
+
+  rr_open();
+  rr_fread(&header, sizeof(header));
+  if (header.type >= RR_NUMBER) {
+    bs_trace_error_time_line("Phy replay: corrupted file %s (request %"PRIu64")\n",
+                             rr_replay_path, rr_n_requests);
+  }
+  if (header.req_size > rr_rec_req_alloc) {
+    rr_rec_req_alloc = header.req_size;
+    rr_rec_req = bs_realloc(rr_rec_req, rr_rec_req_alloc);
+  }
+  rr_fread(rr_rec_req, header.req_size);
+  if (header.resp_size > rr_resp_alloc) {
+    rr_resp_alloc = header.resp_size;
+    rr_resp = bs_realloc(rr_resp, rr_resp_alloc);
+  }
+  rr_fread(rr_resp, header.resp_size);
+  rr_resp_len = header.resp_size;
+
+  if ((header.type != type) || (header.time != now)) {
+    bs_trace_error_time_line("Phy replay: the device diverged from the recording at "
+                             "request %"PRIu64": it did a %s request at %"PRItime"us, "
+                             "but a %s request at %"PRItime"us was recorded\n",
+                             rr_n_requests, rr_type_names[type], now,
+                             rr_type_names[header.type], header.time);
+  }
+  if ((header.req_size != rr_req_len) || (memcmp(rr_req, rr_rec_req, rr_req_len) != 0)) {
+    size_t i = 0;
+    while ((i < BS_MIN(rr_req_len, header.req_size)) && (rr_req[i] == rr_rec_req[i])) {
+      i++;
+    }
+    bs_trace_error_time_line("Phy replay: the device diverged from the recording at "
+                             "request %"PRIu64": the %s request parameters differ "
+                             "(first difference at byte %zu of %zu, %"PRIu32" were recorded)\n",
+                             rr_n_requests, rr_type_names[type], i, rr_req_len,
+                             header.req_size);
+  }
+
+  rr_resp_apply(type, header.ret);
+  rr_n_requests++;
+  return header.ret;
+}
+
+bool hwll_rr_replaying(void){
+  return rr_mode == RR_REPLAY;
+}
+
+int hwll_req_wait(pb_wait_t *wait_s){
+  if (rr_mode == RR_OFF) {
+    return p2G4_dev_req_wait_nc_b(wait_s);
+  }
+  bs_time_t now = tm_get_abs_time();
+  rr_req_len = 0;
+  rr_req_add(wait_s, sizeof(pb_wait_t));
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(RR_WAIT);
+  }
+  int ret = p2G4_dev_req_wait_nc_b(wait_s);
+  rr_record(RR_WAIT, now, ret);
+  return ret;
+}
+
+/*
+ * Get a buffer of <size> bytes in which to assemble the packet for the next
+ * hwll_req_txv2().
+ * The buffer is where the Tx request is serialized for recording or replaying,
+ * so the packet does not need to be copied again before being handed to
+ * libPhyCom or compared with the recording.
+ * It is only valid until the next request.
+ */
+uint8_t *hwll_tx_packet_buf(size_t size){
+  size_t needed = sizeof(p2G4_txv2_t) + size;
+  if (needed > rr_req_alloc) {
+    rr_req_alloc = BS_MAX(needed, 2 * rr_req_alloc);
+    rr_req = bs_realloc(rr_req, rr_req_alloc);
+  }
+  rr_tx_packet = rr_req + sizeof(p2G4_txv2_t);
+  return rr_tx_packet;
+}
+
+int hwll_req_txv2(p2G4_txv2_t *tx_s, uint8_t *packet, p2G4_tx_done_t *tx_done_s){
+  bool in_place = (packet == rr_tx_packet);
+
+  rr_tx_packet = NULL;
+  if (rr_mode == RR_OFF) {
+    return p2G4_dev_req_txv2_nc_b(tx_s, packet, tx_done_s);
+  }
+  bs_time_t now = tm_get_abs_time();
+  rr_tx_done = tx_done_s;
+  if (in_place) {
+    memcpy(rr_req, tx_s, sizeof(p2G4_txv2_t));
+    rr_req_len = sizeof(p2G4_txv2_t) + tx_s->packet_size;
+  } else {
+    rr_req_len = 0;
+    rr_req_add(tx_s, sizeof(p2G4_txv2_t));
+    rr_req_add(packet, tx_s->packet_size);
+  }
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(RR_TX);
+  }
+  int ret = p2G4_dev_req_txv2_nc_b(tx_s, packet, tx_done_s);
+  rr_record(RR_TX, now, ret);
+  return ret;
+}
+
+/*
+ * Common part of the abort reevaluation responses
+ */
+static int rr_provide_new_abort(rr_type_t type, p2G4_abort_t *abort,
+                                int (*phy_call)(p2G4_abort_t *)){
+  if (rr_mode == RR_OFF) {
+    return phy_call(abort);
+  }
+  bs_time_t now = tm_get_abs_time();
+  rr_req_len = 0;
+  rr_req_add(abort, sizeof(p2G4_abort_t));
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(type);
+  }
+  int ret = phy_call(abort);
+  rr_record(type, now, ret);
+  return ret;
+}
+
+int hwll_provide_new_tx_abort(p2G4_abort_t *abort){
+  return rr_provide_new_abort(RR_TX_ABORT, abort, p2G4_dev_provide_new_tx_abort_nc_b);
+}
+
+int hwll_req_rxv2(p2G4_rxv2_t *rx_s, p2G4_address_t *phy_addr,
+                  p2G4_rxv2_done_t *rx_done_s, uint8_t **rx_buf, size_t buf_size){
+  if (rr_mode == RR_OFF) {
+    return p2G4_dev_req_rxv2_nc_b(rx_s, phy_addr, rx_done_s, rx_buf, buf_size);
+  }
+  bs_time_t now = tm_get_abs_time();
+  rr_rx_done = rx_done_s;
+  rr_rx_buf = rx_buf;
+  rr_rx_buf_size = buf_size;
+  rr_req_len = 0;
+  rr_req_add(rx_s, sizeof(p2G4_rxv2_t));
+  rr_req_add(phy_addr, rx_s->n_addr * sizeof(p2G4_address_t));
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(RR_RX);
+  }
+  int ret = p2G4_dev_req_rxv2_nc_b(rx_s, phy_addr, rx_done_s, rx_buf, buf_size);
+  rr_record(RR_RX, now, ret);
+  return ret;
+}
+
+int hwll_provide_new_rxv2_abort(p2G4_abort_t *abort){
+  return rr_provide_new_abort(RR_RX_ABORT, abort, p2G4_dev_provide_new_rxv2_abort_nc_b);
+}
+
+int hwll_rxv2_cont_after_addr(bool accept_rx, p2G4_abort_t *abort){
+  if (rr_mode == RR_OFF) {
+    return p2G4_dev_rxv2_cont_after_addr_nc_b(accept_rx, abort);
+  }
+  bs_time_t now = tm_get_abs_time();
+  uint8_t accept = accept_rx;
+  p2G4_abort_t no_abort;
+  memset(&no_abort, 0, sizeof(no_abort));
+  rr_req_len = 0;
+  rr_req_add(&accept, sizeof(accept));
+  rr_req_add(abort != NULL ? abort : &no_abort, sizeof(p2G4_abort_t));
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(RR_RX_CONT);
+  }
+  int ret = p2G4_dev_rxv2_cont_after_addr_nc_b(accept_rx, abort);
+  rr_record(RR_RX_CONT, now, ret);
+  return ret;
+}
+
+int hwll_req_cca(p2G4_cca_t *cca_s, p2G4_cca_done_t *cca_done_s){
+  if (rr_mode == RR_OFF) {
+    return p2G4_dev_req_cca_nc_b(cca_s, cca_done_s);
+  }
+  bs_time_t now = tm_get_abs_time();
+  rr_cca_done = cca_done_s;
+  rr_req_len = 0;
+  rr_req_add(cca_s, sizeof(p2G4_cca_t));
+  if (rr_mode == RR_REPLAY) {
+    return rr_replay(RR_CCA);
+  }
+  int ret = p2G4_dev_req_cca_nc_b(cca_s, cca_done_s);
+  rr_record(RR_CCA, now, ret);
+  return ret;
+}
+
+int hwll_provide_new_cca_abort(p2G4_abort_t *abort){
+  return rr_provide_new_abort(RR_CCA_ABORT, abort, p2G4_dev_provide_new_cca_abort_nc_b);
+}
+
+static void arg_phy_record_found(char *argv, int offset){
+  if (rr_mode == RR_REPLAY) {
+    bs_trace_error_line("-phy_record and -phy_replay cannot be used together\n");
+  }
+  rr_mode = RR_RECORD;
+}
+
+static void arg_phy_replay_found(char *argv, int offset){
+  if (rr_mode == RR_RECORD) {
+    bs_trace_error_line("-phy_record and -phy_replay cannot be used together\n");
+  }
+  rr_mode = RR_REPLAY;
+}
+
+void hwll_rr_pre_init(void){
+  static bs_args_struct_t args_struct_toadd[] = {
+  { .option = "phy_record",
+    .name = "path",
+    .type = 's',
+    .dest = (void*)&rr_record_path,
+    .call_when_found = arg_phy_record_found,
+    .descript = "Record all requests to the Phy and its responses in this file"
+  },
+  { .option = "phy_replay",
+    .name = "path",
+    .type = 's',
+    .dest = (void*)&rr_replay_path,
+    .call_when_found = arg_phy_replay_found,
+    .descript = "Do not connect to a Phy, but replay its responses from a file recorded "
+                "with -phy_record, stopping at the first request which differs from "
+                "the recorded ones"
+  },
+  ARG_TABLE_ENDMARKER
+  };
+
+  bs_add_extra_dynargs(args_struct_toadd);
+}
+
+void hwll_rr_clean_up(void){
+  if (rr_file != NULL) {
+    if ((rr_mode == RR_REPLAY) && (fgetc(rr_file) != EOF)) {
+      bs_trace_raw(3, "Phy replay: the simulation ended before the recording "
+                   "(after %"PRIu64" requests)\n", rr_n_requests);
+    }
+    fclose(rr_file);
+    rr_file = NULL;
+    rr_file_ctx = NULL;
+  }
+  free(rr_req);
+  free(rr_resp);
+  free(rr_rec_req);
+  rr_req = rr_resp = rr_rec_req = NULL;
+  rr_tx_packet = NULL;
+  rr_req_alloc = rr_resp_alloc = rr_rec_req_alloc = 0;
+}
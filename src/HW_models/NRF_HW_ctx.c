@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Per device contexts of the HW models (see NRF_HW_ctx.h)
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bs_tracing.h"
+#include "bs_oswrap.h"
+#include "NRF_HW_ctx.h"
+
+/* Limits of the per device state sections, provided by the linker */
+extern char __start_nrf_hw_state[];
+extern char __stop_nrf_hw_state[];
+extern char __start_nrf_hw_state_local[];
+extern char __stop_nrf_hw_state_local[];
+
+#define STATE_SIZE (size_t)(__stop_nrf_hw_state - __start_nrf_hw_state)
+#define STATE_LOCAL_SIZE (size_t)(__stop_nrf_hw_state_local - __start_nrf_hw_state_local)
+
+struct nrf_hw_ctx {
+  /* Copy of the state while the context is not active (allocated on demand)
+   * (The NRF_HW_STATE section followed by the NRF_HW_STATE_LOCAL one) */
+  char *state;
+  unsigned int id; /* 0 for the default context, then in creation order */
+};
+
+static nrf_hw_ctx_t default_ctx;
+static nrf_hw_ctx_t *active_ctx = &default_ctx;
+static char *initial_state; /* Copy of the state before any model was initialized */
+/*
+ * Number of users of initial_state: the default context until it is cleaned up,
+ * and each context created from it until it is deleted.
+ * It is freed when the last one is gone.
+ */
+static unsigned int initial_state_users;
+static bool default_ctx_cleaned_up;
+static unsigned int n_ctx_created;
+
+void *nrf_hw_ctx_state_get(void){
+  return __start_nrf_hw_state;
+}
+
+size_t nrf_hw_ctx_state_size(void){
+  return STATE_SIZE;
+}
+
+static void save_state(char *state){
+  memcpy(state, __start_nrf_hw_state, STATE_SIZE);
+  memcpy(state + STATE_SIZE, __start_nrf_hw_state_local, STATE_LOCAL_SIZE);
+}
+
+static void load_state(const char *state){
+  memcpy(__start_nrf_hw_state, state, STATE_SIZE);
+  memcpy(__start_nrf_hw_state_local, state + STATE_SIZE, STATE_LOCAL_SIZE);
+}
+
+void nrf_hw_ctx_pre_init(void){
+  if (initial_state != NULL) {
+    return;
+  }
+  initial_state = bs_malloc(STATE_SIZE + STATE_LOCAL_SIZE);
+  save_state(initial_state);
+  initial_state_users = 1;
+}
+
+static void initial_state_release(void){
+  if ((initial_state_users > 0) && (--initial_state_users == 0)) {
+    free(initial_state);
+    initial_state = NULL;
+  }
+}
+
+void nrf_hw_ctx_clean_up(void){
+  if (active_ctx == &default_ctx) {
+    free(default_ctx.state);
+    default_ctx.state = NULL;
+    if (!default_ctx_cleaned_up) {
+      default_ctx_cleaned_up = true;
+      initial_state_release();
+    }
+  }
+}
+
+nrf_hw_ctx_t *nrf_hw_ctx_new(void){
+  if (initial_state == NULL) {
+    bs_trace_error_line("%s: nrf_hw_pre_init() must be called first\n", __func__);
+  }
+  nrf_hw_ctx_t *ctx = bs_malloc(sizeof(nrf_hw_ctx_t));
+  ctx->state = bs_malloc(STATE_SIZE + STATE_LOCAL_SIZE);
+  memcpy(ctx->state, initial_state, STATE_SIZE + STATE_LOCAL_SIZE);
+  ctx->id = ++n_ctx_created;
+  initial_state_users++;
+  return ctx;
+}
+
+void nrf_hw_ctx_delete(nrf_hw_ctx_t *ctx){
+  if ((ctx == active_ctx) || (ctx == &default_ctx)) {
+    bs_trace_error_line("%s: The active or default context cannot be deleted\n", __func__);
+  }
+  free(ctx->state);
+  free(ctx);
+  initial_state_release();
+}
+
+void nrf_hw_ctx_switch(nrf_hw_ctx_t *ctx){
+  if (ctx == active_ctx) {
+    return;
+  }
+  if (active_ctx->state == NULL) {
+    active_ctx->state = bs_malloc(STATE_SIZE + STATE_LOCAL_SIZE);
+  }
+  save_state(active_ctx->state);
+  load_state(ctx->state);
+  active_ctx = ctx;
+}
+
+nrf_hw_ctx_t *nrf_hw_ctx_get_active(void){
+  return active_ctx;
+}
+
+nrf_hw_ctx_t *nrf_hw_ctx_get_default(void){
+  return &default_ctx;
+}
+
+unsigned int nrf_hw_ctx_get_id(nrf_hw_ctx_t *ctx){
+  return ctx->id;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Per device contexts of the HW models
+ *
+ * All the HW models state which belongs to one simulated device (registers
+ * and internal state) is kept in variables marked with NRF_HW_STATE or
+ * NRF_HW_STATE_LOCAL, which the linker places together in two sections.
+ * A context is a copy of those sections. Switching the active context saves the
+ * sections content into the previously active context and loads the new one,
+ * so the models (and the SW which accesses the registers) keep using the same
+ * addresses regardless of which device is being simulated.
+ *
+ * Several devices can be simulated in one process by creating one context
+ * per device, and switching to it before calling into the HW models
+ * for that device (including nrf_hw_initialize() and nrf_hw_models_free_all()).
+ * The overall scheduler (time machine) state needs to be switched accordingly
+ * by the integrating program.
+ *
+ * Limitations:
+ *  * The Phy link is not part of a context: libPhyCom keeps a single connection
+ *    per process, so at most one of the devices may use the radio (see
+ *    NRF_HWLowL.c). The others must not have any radio activity.
+ *  * Each switch copies both sections out and in (save + load), whatever part of
+ *    them the models actually use. Together they are over 10KB
+ *    (nrf_hw_ctx_state_size() gives the NRF_HW_STATE part), so switch
+ *    per simulated event, not per register access.
+ *    Big optional tables (like statistics) are therefore better kept in the heap,
+ *    with only a pointer to them in the context.
+ *
+ * A program which does not use this API simulates one device on the default
+ * context, and pays no cost for it.
+ */
+#ifndef _NRF_HW_CTX_H
+#define _NRF_HW_CTX_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * Mark a variable as part of the per device state
+ * (it must not be const, and it must not be shared between devices)
+ */
+#define NRF_HW_STATE __attribute__((section("nrf_hw_state")))
+
+/*
+ * Mark a variable as part of the per device state which is only meaningful
+ * in this process, like pointers to functions, heap or open files, or the
+ * process configuration.
+ * These are not saved in snapshots (see NRF_HW_snapshot.h)
+ */
+#define NRF_HW_STATE_LOCAL __attribute__((section("nrf_hw_state_local")))
+
+typedef struct nrf_hw_ctx nrf_hw_ctx_t;
+
+/*
+ * Take a copy of the initial (reset) state of all models,
+ * from which new contexts will be created.
+ * Called from nrf_hw_pre_init()
+ */
+void nrf_hw_ctx_pre_init(void);
+
+/*
+ * Free the default context resources, if it is the active one
+ * (called from nrf_hw_models_free_all()).
+ * The initial state is kept until both the default context has been cleaned up
+ * and all other contexts have been deleted.
+ */
+void nrf_hw_ctx_clean_up(void);
+
+/*
+ * Create a new context, in its initial state.
+ * (nrf_hw_initialize() still needs to be called for it after switching to it)
+ */
+nrf_hw_ctx_t *nrf_hw_ctx_new(void);
+
+/*
+ * Delete a context which is not the active one nor the default one
+ * (nrf_hw_models_free_all() should have been called for it before)
+ */
+void nrf_hw_ctx_delete(nrf_hw_ctx_t *ctx);
+
+/*
+ * Make <ctx> the active context
+ */
+void nrf_hw_ctx_switch(nrf_hw_ctx_t *ctx);
+
+nrf_hw_ctx_t *nrf_hw_ctx_get_active(void);
+nrf_hw_ctx_t *nrf_hw_ctx_get_default(void);
+
+/*
+ * Number identifying <ctx>: 0 for the default context, and 1, 2, ..
+ * for the others, in creation order.
+ * Models which write to a file given in the command line use it to give each
+ * device its own file
+ */
+unsigned int nrf_hw_ctx_get_id(nrf_hw_ctx_t *ctx);
+
+/*
+ * Location and size in bytes of the active device state
+ * (only the NRF_HW_STATE part)
+ */
+void *nrf_hw_ctx_state_get(void);
+size_t nrf_hw_ctx_state_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
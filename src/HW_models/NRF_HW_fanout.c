@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Fan-out of the simulation into several child processes (see NRF_HW_fanout.h)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bs_oswrap.h"
+#include "bs_rand_main.h"
+#include "NRF_HW_fanout.h"
+#include "NRF_HW_model_top.h"
+#include "NRF_HW_ctx.h"
+#include "NRF_HWLowL.h"
+#include "NRF_NVMC.h"
+#include "NRF_GPIO_backend.h"
+
+static NRF_HW_STATE bs_time_t Timer_fanout = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t fanout_timer;
+static NRF_HW_STATE_LOCAL nrf_hw_sub_args_t *fanout_args;
+
+static int fanout_child = -1; /* Belongs to the process, not to the device */
+
+static void nrf_hw_fanout_timer_triggered(void);
+
+__attribute__((weak)) void nrf_hw_fanout_child_start(unsigned int child){
+}
+
+int nrf_hw_fanout_get_child(void){
+  return fanout_child;
+}
+
+void nrf_hw_fanout_init(nrf_hw_sub_args_t *args){
+  fanout_args = args;
+
+  if (args->fanout_n == 0) {
+    return;
+  }
+  if ((args->fanout_gpio_in_file != NULL)
+      && (strstr(args->fanout_gpio_in_file, "%i") == NULL)) {
+    bs_trace_error_line("-hw_fanout_gpio_in_file must contain %%i (%s)\n",
+                        args->fanout_gpio_in_file);
+  }
+
+  fanout_timer = nrf_hw_timer_register("Fan-out timer", NRF_HW_TIMER_PRIO_FANOUT,
+                                       nrf_hw_fanout_timer_triggered);
+  Timer_fanout = (bs_time_t)args->fanout_time;
+  nrf_hw_timer_update(fanout_timer, Timer_fanout);
+}
+
+/*
+ * Return (in a newly allocated string) <pattern> with %i replaced by <child>
+ */
+static char *nrf_hw_fanout_child_path(const char *pattern, unsigned int child){
+  const char *marker = strstr(pattern, "%i");
+  char *path = bs_malloc(strlen(pattern) + 12);
+
+  sprintf(path, "%.*s%u%s", (int)(marker - pattern), pattern, child, marker + 2);
+  return path;
+}
+
+/*
+ * Set up the stimulus of a just forked child
+ */
+static void nrf_hw_fanout_child_setup(unsigned int child){
+  char *gpio_in_file = NULL;
+
+  fanout_child = child;
+
+  nrfhw_nvmc_fanout_child();
+
+  if (fanout_args->fanout_reseed) {
+    bs_random_init(fanout_args->fanout_seed + child);
+  }
+
+  if (fanout_args->fanout_gpio_in_file != NULL) {
+    gpio_in_file = nrf_hw_fanout_child_path(fanout_args->fanout_gpio_in_file, child);
+  }
+  nrf_gpio_backend_fanout_child(child, gpio_in_file);
+
+  bs_trace_raw_time(3, "NRF HW: Fan-out child %u started\n", child);
+
+  nrf_hw_fanout_child_start(child);
+}
+
+/*
+ * Wait for the <n> children in <pids> to finish,
+ * and return how many of them failed
+ */
+static unsigned int nrf_hw_fanout_wait_children(pid_t *pids, unsigned int n){
+  unsigned int n_failed = 0;
+
+  for (unsigned int i = 0; i < n; i++) {
+    int status;
+    pid_t pid;
+
+    do {
+      pid = wait(&status);
+    } while ((pid == -1) && (errno == EINTR));
+    if (pid == -1) {
+      bs_trace_error_line("%s: Failed to wait for the fan-out children: %s\n",
+                          __func__, strerror(errno));
+    }
+
+    unsigned int child = 0;
+    while ((child < n) && (pids[child] != pid)) {
+      child++;
+    }
+
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+      bs_trace_raw(3, "NRF HW: Fan-out child %u completed\n", child);
+    } else {
+      n_failed++;
+      if (WIFEXITED(status)) {
+        bs_trace_warning_line("Fan-out child %u failed (exit code %i)\n",
+                              child, WEXITSTATUS(status));
+      } else {
+        bs_trace_warning_line("Fan-out child %u failed (terminated by signal %i)\n",
+                              child, WTERMSIG(status));
+      }
+    }
+  }
+
+  return n_failed;
+}
+
+/*
+ * Fan-out time reached: Fork the children.
+ * The children return from here and continue the simulation,
+ * the parent waits for all of them and exits.
+ */
+static void nrf_hw_fanout_timer_triggered(void){
+  unsigned int n = fanout_args->fanout_n;
+  unsigned int n_started;
+  pid_t *pids;
+
+  Timer_fanout = TIME_NEVER;
+  nrf_hw_timer_update(fanout_timer, Timer_fanout);
+
+  if (!hwll_get_nosim()) {
+    bs_trace_error_time_line("The simulation fan-out (-hw_fanout_n) requires -nosim\n");
+  }
+
+  nrf_gpio_backend_fanout_prepare();
+  /* Otherwise what is pending in the buffers would be output by each child */
+  fflush(NULL);
+
+  pids = bs_malloc(n * sizeof(pid_t));
+
+  for (n_started = 0; n_started < n; n_started++) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+      free(pids);
+      nrf_hw_fanout_child_setup(n_started);
+      return;
+    } else if (pid == -1) {
+      bs_trace_warning_line("Failed to fork fan-out child %u: %s\n",
+                            n_started, strerror(errno));
+      break;
+    }
+    pids[n_started] = pid;
+  }
+
+  bs_trace_raw_time(3, "NRF HW: %u fan-out children started, waiting for them\n", n_started);
+
+  unsigned int n_failed = nrf_hw_fanout_wait_children(pids, n_started);
+  free(pids);
+
+  if ((n_failed > 0) || (n_started < n)) {
+    bs_trace_error_line("%u of %u fan-out children failed\n", n_failed + n - n_started, n);
+  }
+  bs_trace_exit_line("All %u fan-out children completed\n", n);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Fan-out of the simulation into several child processes
+ *
+ * When enabled with -hw_fanout_n=<n>, the device simulation runs normally until
+ * -hw_fanout_time. At that point the process forks <n> children, each of which
+ * continues the simulation from that same (warmed up) state, but with its own
+ * stimulus:
+ *   * Its own random seed (-hw_fanout_seed)
+ *   * Its own GPIO input file (-hw_fanout_gpio_in_file)
+ *   * Whatever the integrating program does in nrf_hw_fanout_child_start()
+ *     (for ex. fault injection)
+ * The flash and UICR of each child become private copy-on-write copies,
+ * so the children do not affect each other or the parent files.
+ *
+ * The parent waits for all children to finish, and exits with an error
+ * if any of them failed.
+ *
+ * As the children cannot share the parent connection to the Phy,
+ * this can only be used with -nosim.
+ */
+#ifndef _NRF_HW_FANOUT_H
+#define _NRF_HW_FANOUT_H
+
+#include "NRF_hw_args.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+void nrf_hw_fanout_init(nrf_hw_sub_args_t *args);
+
+/*
+ * Child number of this process (0..n-1), or -1 if this is not a fan-out child
+ */
+int nrf_hw_fanout_get_child(void);
+
+/*
+ * Hook for the integrating program, called in each child right after it has
+ * been forked, and its stimulus set.
+ * (A weak empty version is provided)
+ */
+void nrf_hw_fanout_child_start(unsigned int child);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,7 +3,11 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <string.h>
+#include <time.h>
 #include "bs_tracing.h"
+#include "NRF_HW_trace.h"
+#include "NRF_HW_fanout.h"
 #include "bs_types.h"
 #include "bs_utils.h"
 #include "NRF_HW_model_top.h"
@@ -28,8 +32,370 @@
 #include "irq_ctrl.h"
 #include "BLECrypt_if.h"
 #include "fake_timer.h"
+#include "NRF_HWLowL.h"
+#include "NRF_HW_ctx.h"
+
+int nrf_hw_trace_level = NRF_HW_TRACE_MAX_LEVEL; //Until the models are initialized, let the tracing library decide
+
+/**
+ * Refresh our copy of the tracing library verbosity level
+ * (needs to be called again if it is changed after the HW models initialization)
+ */
+void nrf_hw_trace_level_update(void){
+  nrf_hw_trace_level = -1;
+  for (int level = 0; level <= NRF_HW_TRACE_MAX_LEVEL; level++){
+    if ( bs_trace_will_it_print(level) ){
+      nrf_hw_trace_level = level;
+    }
+  }
+}
+
+NRF_HW_STATE bs_time_t timer_nrf_main_timer = TIME_NEVER; //This timer is exposed to the top level time_machine which will call us when it is reached
+
+/*
+ * Registered HW model event timers, indexed by their handle
+ * (their registration order)
+ */
+static NRF_HW_STATE uint nrf_hw_n_registered;
+static NRF_HW_STATE_LOCAL nrf_hw_timer_cb_t nrf_hw_timers_cb[NRF_HW_MAX_TIMERS];
+static NRF_HW_STATE_LOCAL const char *nrf_hw_timers_name[NRF_HW_MAX_TIMERS];
+static NRF_HW_STATE nrf_hw_timer_prio_t nrf_hw_timers_prio[NRF_HW_MAX_TIMERS];
+
+/*
+ * Active HW model event timers, indexed by their position (leaf) in the tree
+ *
+ * A registered timer only becomes active (is added to the tree) the first time
+ * it is set to something else than TIME_NEVER, so peripherals which are never
+ * used do not add to the scheduling cost.
+ * The active timers are kept sorted by priority (and for equal priority, by
+ * handle), so their leaf is also their priority order.
+ * nrf_hw_timers_leaf[] maps each handle to its current leaf
+ * (NRF_HW_TIMER_INACTIVE while not active), and nrf_hw_timers_handle[] back.
+ */
+#define NRF_HW_TIMER_INACTIVE UINT8_MAX
+static NRF_HW_STATE uint nrf_hw_n_timers;
+static NRF_HW_STATE bs_time_t nrf_hw_timers[NRF_HW_MAX_TIMERS] __attribute__((aligned(64)));
+static NRF_HW_STATE uint8_t nrf_hw_timers_handle[NRF_HW_MAX_TIMERS];
+static NRF_HW_STATE uint8_t nrf_hw_timers_leaf[NRF_HW_MAX_TIMERS];
+
+/* Leaf of the next timer to trigger */
+static NRF_HW_STATE uint nrf_hw_next_timer_to_trigger;
+
+/* Dispatch all timers due at the same time in one call (see nrf_hw_some_timer_reached()) */
+static NRF_HW_STATE_LOCAL bool nrf_hw_batch_dispatch;
+/*
+ * Deferred rescheduling (see nrf_hw_sched_defer_begin()):
+ * nesting depth of the open brackets, and if the next timer needs to be
+ * re-evaluated when the outermost one is closed
+ */
+static NRF_HW_STATE uint nrf_hw_sched_defer_depth;
+static NRF_HW_STATE bool nrf_hw_sched_dirty;
+
+/* Number of next timer re-evaluations done, and how many were avoided by deferring them */
+static NRF_HW_STATE uint64_t nrf_hw_sched_n_recomputes;
+static NRF_HW_STATE uint64_t nrf_hw_sched_n_recomputes_saved;
+
+/*
+ * Optional profiling of the HW events dispatch (-hw_profile)
+ */
+static NRF_HW_STATE_LOCAL bool nrf_hw_profile;
+static NRF_HW_STATE_LOCAL bs_time_t nrf_hw_profile_period; //Period in which the profiling report is dumped (0: only at exit)
+static NRF_HW_STATE_LOCAL bs_time_t nrf_hw_profile_next_dump;
+static NRF_HW_STATE_LOCAL bs_time_t nrf_hw_profile_sim_start;
+static NRF_HW_STATE_LOCAL uint64_t nrf_hw_profile_host_start;
+
+static NRF_HW_STATE_LOCAL struct {
+  uint64_t n_dispatches;
+  uint64_t host_ns;        //Host time spent in this timer handler
+  bs_time_t sim_between;   //Simulated time accumulated between consecutive dispatches
+  bs_time_t last_dispatch; //Simulated time of the last dispatch
+} nrf_hw_profile_st[NRF_HW_MAX_TIMERS]; //Indexed by handle
+
+/*
+ * Power of 2 number of leaves of the timers tournament tree
+ * (>= nrf_hw_n_timers, so timers which are not active do not add to its depth)
+ */
+static NRF_HW_STATE uint nrf_hw_timers_tree_leaves = 2;
+_Static_assert((NRF_HW_MAX_TIMERS & (NRF_HW_MAX_TIMERS - 1)) == 0,
+               "NRF_HW_MAX_TIMERS must be a power of 2");
+
+/*
+ * Tournament (winner) tree over nrf_hw_timers[]
+ *
+ * Node 1 is the root, and node n has as children the nodes 2n and 2n+1.
+ * Nodes [nrf_hw_timers_tree_leaves, 2*nrf_hw_timers_tree_leaves) are the leaves
+ * (the leaf i is the node nrf_hw_timers_tree_leaves + i), and therefore not stored.
+ * Each internal node keeps the leaf index of the timer which won in its subtree:
+ * the one with the earliest time, or, if several have the same time,
+ * the one with the highest priority (lowest leaf index)
+ */
+static NRF_HW_STATE uint8_t nrf_hw_timers_tree[NRF_HW_MAX_TIMERS];
+
+static inline uint nrf_hw_timers_tree_node_winner(uint node){
+  if ( node >= nrf_hw_timers_tree_leaves ){
+    return node - nrf_hw_timers_tree_leaves;
+  } else {
+    return nrf_hw_timers_tree[node];
+  }
+}
+
+static inline void nrf_hw_timers_tree_play(uint node){
+  //All timers in the left subtree have a lower index (higher priority) than
+  //those in the right one, so the left one wins ties
+  uint left  = nrf_hw_timers_tree_node_winner(2*node);
+  uint right = nrf_hw_timers_tree_node_winner(2*node + 1);
+
+  if ( nrf_hw_timers[right] < nrf_hw_timers[left] ){
+    nrf_hw_timers_tree[node] = right;
+  } else {
+    nrf_hw_timers_tree[node] = left;
+  }
+}
+
+/**
+ * (Re)build the complete tree, resizing it for the current number of timers
+ */
+static void nrf_hw_timers_tree_build(void){
+  nrf_hw_timers_tree_leaves = 2;
+  while ( nrf_hw_timers_tree_leaves < nrf_hw_n_timers ){
+    nrf_hw_timers_tree_leaves <<= 1;
+  }
+  for (uint i = nrf_hw_n_timers; i < nrf_hw_timers_tree_leaves; i++){
+    nrf_hw_timers[i] = TIME_NEVER;
+  }
+  for (uint node = nrf_hw_timers_tree_leaves - 1; node >= 1; node--){
+    nrf_hw_timers_tree_play(node);
+  }
+}
+
+static void nrf_hw_timers_tree_init(void){
+  nrf_hw_n_registered = 0;
+  nrf_hw_n_timers = 0;
+  nrf_hw_timers_tree_build();
+}
+
+/**
+ * Replay only the matches in the path from <leaf> to the root
+ */
+static inline void nrf_hw_timers_tree_update(uint leaf){
+  for (uint node = (nrf_hw_timers_tree_leaves + leaf) >> 1; node >= 1; node >>= 1){
+    nrf_hw_timers_tree_play(node);
+  }
+}
+
+nrf_hw_timer_handle_t nrf_hw_timer_register(const char *name,
+                                            nrf_hw_timer_prio_t priority,
+                                            nrf_hw_timer_cb_t callback){
+  if ( nrf_hw_n_registered >= NRF_HW_MAX_TIMERS ){
+    bs_trace_error_line("Too many HW timers registered (max %i), cannot register %s\n",
+                        NRF_HW_MAX_TIMERS, name);
+  }
+  if ( (uint)priority >= NRF_HW_TIMER_PRIO_NUMBER ){
+    bs_trace_error_line("HW timer %s registered with invalid priority %i\n",
+                        name, priority);
+  }
+  if ( callback == NULL ){
+    bs_trace_error_line("HW timer %s registered without callback\n", name);
+  }
+
+  for (uint h = 0; h < nrf_hw_n_registered; h++){
+    if ( (nrf_hw_timers_prio[h] == NRF_HW_TIMER_PRIO_RADIO_ABORT_REEVAL)
+        && (priority == NRF_HW_TIMER_PRIO_RADIO_ABORT_REEVAL) ){
+      bs_trace_error_line("Only one HW timer may have the lowest priority (%s)\n", name);
+    }
+  }
+
+  nrf_hw_timer_handle_t handle = nrf_hw_n_registered++;
+  nrf_hw_timers_cb[handle] = callback;
+  nrf_hw_timers_name[handle] = name;
+  nrf_hw_timers_prio[handle] = priority;
+  nrf_hw_timers_leaf[handle] = NRF_HW_TIMER_INACTIVE;
+
+  return handle;
+}
+
+/**
+ * Add the registered timer <handle> to the tree
+ * Returns its leaf
+ */
+static uint nrf_hw_timer_activate(nrf_hw_timer_handle_t handle){
+  nrf_hw_timer_prio_t priority = nrf_hw_timers_prio[handle];
+
+  //Find its position: after all the timers with a higher priority,
+  //or with the same priority but registered earlier
+  uint leaf = 0;
+  while ( (leaf < nrf_hw_n_timers)
+          && ( (nrf_hw_timers_prio[nrf_hw_timers_handle[leaf]] < priority)
+              || ( (nrf_hw_timers_prio[nrf_hw_timers_handle[leaf]] == priority)
+                  && (nrf_hw_timers_handle[leaf] < handle) ) ) ){
+    leaf++;
+  }
+
+  for (uint i = nrf_hw_n_timers; i > leaf; i--){
+    nrf_hw_timers[i] = nrf_hw_timers[i-1];
+    nrf_hw_timers_handle[i] = nrf_hw_timers_handle[i-1];
+    nrf_hw_timers_leaf[nrf_hw_timers_handle[i]] = i;
+  }
+
+  nrf_hw_timers[leaf] = TIME_NEVER;
+  nrf_hw_timers_handle[leaf] = handle;
+  nrf_hw_timers_leaf[handle] = leaf;
+
+  nrf_hw_n_timers++;
+  nrf_hw_timers_tree_build();
+
+  NRF_HW_TRACE_RAW_MANUAL_TIME(8, tm_get_abs_time(), "NRF HW: %s activated\n",
+                               nrf_hw_timers_name[handle]);
+  return leaf;
+}
+
+/**
+ * Update timer_nrf_main_timer and nrf_hw_next_timer_to_trigger from the
+ * tournament tree root, and notify the time machine if the time changed
+ */
+void nrf_hw_find_next_timer_to_trigger(){
+  if ( nrf_hw_sched_defer_depth > 0 ){
+    if ( nrf_hw_sched_dirty ){
+      nrf_hw_sched_n_recomputes_saved++;
+    }
+    nrf_hw_sched_dirty = true;
+    return;
+  }
+  nrf_hw_sched_n_recomputes++;
+  nrf_hw_next_timer_to_trigger = nrf_hw_timers_tree[1];
+  bs_time_t new_timer = nrf_hw_timers[nrf_hw_next_timer_to_trigger];
+
+  if ( new_timer != timer_nrf_main_timer ){
+    timer_nrf_main_timer = new_timer;
+    tm_find_next_timer_to_trigger();
+  }
+}
+
+void nrf_hw_snapshot_restored(void){
+  nrf_hw_next_timer_to_trigger = nrf_hw_timers_tree[1];
+  timer_nrf_main_timer = nrf_hw_timers[nrf_hw_next_timer_to_trigger];
+  tm_find_next_timer_to_trigger();
+}
+
+void nrf_hw_sched_defer_begin(void){
+  nrf_hw_sched_defer_depth++;
+}
+
+void nrf_hw_sched_defer_end(void){
+  if ( nrf_hw_sched_defer_depth == 0 ){
+    bs_trace_error_line("nrf_hw_sched_defer_end() called without nrf_hw_sched_defer_begin()\n");
+  }
+  if ( ( --nrf_hw_sched_defer_depth == 0 ) && nrf_hw_sched_dirty ){
+    nrf_hw_sched_dirty = false;
+    nrf_hw_find_next_timer_to_trigger();
+  }
+}
+
+void nrf_hw_sched_get_stats(uint64_t *recomputes, uint64_t *recomputes_saved){
+  *recomputes = nrf_hw_sched_n_recomputes;
+  *recomputes_saved = nrf_hw_sched_n_recomputes_saved;
+}
+
+/**
+ * Set the HW model event timer <timer> to <value>
+ * To be called each time a "timed process" updates its timer
+ */
+void nrf_hw_timer_update(nrf_hw_timer_handle_t timer, bs_time_t value){
+  uint leaf = nrf_hw_timers_leaf[timer];
+  if ( leaf == NRF_HW_TIMER_INACTIVE ){
+    if ( value == TIME_NEVER ){
+      return;
+    }
+    leaf = nrf_hw_timer_activate(timer);
+  }
+  nrf_hw_timers[leaf] = value;
+  nrf_hw_timers_tree_update(leaf);
+  nrf_hw_find_next_timer_to_trigger();
+}
+
+static uint64_t nrf_hw_profile_host_ns(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static void nrf_hw_profile_init(nrf_hw_sub_args_t *args){
+  nrf_hw_profile = args->profile;
+  if ( !nrf_hw_profile ){
+    return;
+  }
+  memset(nrf_hw_profile_st, 0, sizeof(nrf_hw_profile_st));
+  nrf_hw_profile_period = args->profile_period > 0 ? args->profile_period * 1e6 : 0;
+  nrf_hw_profile_sim_start = tm_get_abs_time();
+  nrf_hw_profile_host_start = nrf_hw_profile_host_ns();
+  nrf_hw_profile_next_dump = nrf_hw_profile_period > 0 ?
+                             nrf_hw_profile_sim_start + nrf_hw_profile_period : TIME_NEVER;
+}
+
+static void nrf_hw_profile_dump(void){
+  bs_time_t sim_elapsed = tm_get_abs_time() - nrf_hw_profile_sim_start;
+  uint64_t host_elapsed = nrf_hw_profile_host_ns() - nrf_hw_profile_host_start;
+  uint64_t host_in_hw = 0;
+
+  for (uint h = 0; h < nrf_hw_n_registered; h++){
+    host_in_hw += nrf_hw_profile_st[h].host_ns;
+  }
+
+  bs_trace_raw_time(1, "NRF HW profile: %"PRItime" us simulated in %.3f s "
+                    "(real time factor %.2f), %.3f s in HW event handlers\n",
+                    sim_elapsed, host_elapsed/1e9,
+                    host_elapsed > 0 ? sim_elapsed*1e3/host_elapsed : 0.0,
+                    host_in_hw/1e9);
+  bs_trace_raw_time(1, "NRF HW profile: next timer re-evaluated %"PRIu64" times "
+                    "(%"PRIu64" avoided by deferring)\n",
+                    nrf_hw_sched_n_recomputes, nrf_hw_sched_n_recomputes_saved);
+
+  for (uint h = 0; h < nrf_hw_n_registered; h++){
+    uint64_t n = nrf_hw_profile_st[h].n_dispatches;
+    if ( n == 0 ){
+      continue;
+    }
+    bs_trace_raw_time(1, "NRF HW profile: %-24s %10"PRIu64" dispatches, "
+                      "%12"PRIu64" ns host (%6.0f ns/dispatch), "
+                      "%10.1f us simulated between events\n",
+                      nrf_hw_timers_name[h], n,
+                      nrf_hw_profile_st[h].host_ns,
+                      (double)nrf_hw_profile_st[h].host_ns/n,
+                      n > 1 ? (double)nrf_hw_profile_st[h].sim_between/(n - 1) : 0.0);
+  }
+}
+
+/*
+ * Dispatch the timer <handle> while accounting for it
+ * and dump the profiling report if its period elapsed
+ */
+static void nrf_hw_profile_dispatch(uint handle){
+  bs_time_t now = tm_get_abs_time();
+
+  if ( nrf_hw_profile_st[handle].n_dispatches > 0 ){
+    nrf_hw_profile_st[handle].sim_between += now - nrf_hw_profile_st[handle].last_dispatch;
+  }
+  nrf_hw_profile_st[handle].last_dispatch = now;
+  nrf_hw_profile_st[handle].n_dispatches++;
+
+  uint64_t t0 = nrf_hw_profile_host_ns();
+  nrf_hw_timers_cb[handle]();
+  nrf_hw_profile_st[handle].host_ns += nrf_hw_profile_host_ns() - t0;
+
+  if ( now >= nrf_hw_profile_next_dump ){
+    nrf_hw_profile_dump();
+    nrf_hw_profile_next_dump = now + nrf_hw_profile_period;
+  }
+}
 
 void nrf_hw_models_free_all(){
+  if ( nrf_hw_profile ){
+    nrf_hw_profile_dump();
+  } else {
+    bs_trace_raw(5, "NRF HW: next timer re-evaluated %"PRIu64" times (%"PRIu64" avoided by deferring)\n",
+                 nrf_hw_sched_n_recomputes, nrf_hw_sched_n_recomputes_saved);
+  }
+
   BLECrypt_if_free();
   fake_timer_cleanup();
   hw_irq_ctrl_cleanup();
@@ -48,6 +414,8 @@ void nrf_hw_models_free_all(){
   nrf_egu_clean_up();
   nrfhw_nvmc_uicr_clean_up();
   nrf_hw_model_timer_clean_up();
+  hwll_rr_clean_up();
+  nrf_hw_ctx_clean_up();
 }
 
 /*
@@ -55,7 +423,10 @@ void nrf_hw_models_free_all(){
  * Like registering command line arguments or dump files
  */
 void nrf_hw_pre_init() {
+  nrf_hw_ctx_pre_init();
   nrfhw_nvmc_uicr_pre_init();
+  hwll_rr_pre_init();
+  hw_irq_ctrl_pre_init();
 }
 
 /*
@@ -63,8 +434,14 @@ void nrf_hw_pre_init() {
  */
 void nrf_hw_initialize(nrf_hw_sub_args_t *args){
 
+  nrf_hw_trace_level_update();
+  nrf_hw_timers_tree_init();
+  nrf_hw_batch_dispatch = args->batch_dispatch;
+  nrf_hw_profile_init(args);
+  nrf_hw_fanout_init(args);
   BLECrypt_if_enable_real_encryption(args->useRealAES);
   fake_timer_init();
+  bst_ticker_init();
   hw_irq_ctrl_init();
   nrf_clock_init();
   nrf_rng_init();
@@ -78,156 +455,168 @@ void nrf_hw_initialize(nrf_hw_sub_args_t *args){
   nrf_gpio_init();
   nrf_gpiote_init();
   nrf_ppi_init();
+  nrf_ppi_stats_enable(args->ppi_stats);
   nrf_egu_init();
   nrfhw_nvmc_uicr_init();
   nrf_hw_model_timer_init();
   nrf_hw_find_next_timer_to_trigger();
 }
 
-extern bs_time_t Timer_event_fw_test_ticker;
-extern bs_time_t Timer_irq_ctrl;
-extern bs_time_t Timer_RNG;
-extern bs_time_t Timer_TEMP;
-extern bs_time_t Timer_NVMC;
-extern bs_time_t Timer_CLOCK;
-extern bs_time_t Timer_GPIO_input;
-extern bs_time_t Timer_RTC;
-extern bs_time_t Timer_TIMERs;
-extern bs_time_t Timer_RADIO;
-extern bs_time_t Timer_RADIO_abort_reeval; //This timer should have the lowest priority
-extern bs_time_t Timer_ECB;
-extern bs_time_t Timer_AAR;
-extern bs_time_t Timer_fake_timer;
-extern bs_time_t Timer_RADIO_bitcounter;
-
-//The events priorities are as in this enum from top to bottom
-// (priority == which executes if they have the same timing)
-typedef enum {
-  fake_timer,
-  fw_test_ticker,
-  irq_ctrl_timer,
-  RNG_timer,
-  TEMP_timer,
-  NVMC_timer,
-  ECB_timer,
-  AAR_timer,
-  CLOCK_timer,
-  GPIO_input,
-  RTC_timer,
-  TIMER_timer,
-  RADIO_timer,
-  RADIO_bitcounter,
-  RADIO_abort_reeval_timer,
-  NumberOfNRFHWTimers,
-  None
-} NRF_HW_next_timer_to_trigger_t;
-
-static bs_time_t *Timers[NumberOfNRFHWTimers] = { //Indexed with NRF_HW_next_timer_to_trigger_t
-    &Timer_fake_timer,
-    &Timer_event_fw_test_ticker,
-    &Timer_irq_ctrl,
-    &Timer_RNG,
-    &Timer_TEMP,
-    &Timer_NVMC,
-    &Timer_ECB,
-    &Timer_AAR,
-    &Timer_CLOCK,
-    &Timer_GPIO_input,
-    &Timer_RTC,
-    &Timer_TIMERs,
-    &Timer_RADIO,
-    &Timer_RADIO_bitcounter,
-    &Timer_RADIO_abort_reeval //This timer should always be the latest in this list (lowest priority)
-};
-
-bs_time_t timer_nrf_main_timer = TIME_NEVER; //This timer is exposed to the top level time_machine which will call us when it is reached
-static NRF_HW_next_timer_to_trigger_t nrf_hw_next_timer_to_trigger = None;
+static void nrf_hw_timer_dispatch(uint leaf){
+  if ( leaf >= nrf_hw_n_timers ){
+    bs_trace_error_line("nrf_hw_next_timer_to_trigger corrupted\n");
+  }
+  uint handle = nrf_hw_timers_handle[leaf];
+  NRF_HW_TRACE_RAW_MANUAL_TIME(8, tm_get_abs_time(),"NRF HW: %s\n", nrf_hw_timers_name[handle]);
 
-/**
- * Look into all timers and update  next_timer_to_trigger* accordingly
- * To be called each time a "timed process" updates its timer
+  /*
+   * A task triggered thru the PPI by several events raised by a peripheral
+   * event handler is only triggered once (by the first one), as events on the
+   * same clock edge would in HW.
+   * The fanout, the test ticker and the interrupt controller (which awakes
+   * the CPU and runs the SW ISRs) are not peripherals and are run without
+   * this window, so the SW PPI triggers are never dropped
+   */
+  bool coalesce = ( nrf_hw_timers_prio[handle] > NRF_HW_TIMER_PRIO_IRQ_CTRL );
+
+  if ( coalesce ){
+    nrf_ppi_coalesce_begin();
+  }
+  if ( nrf_hw_profile ){
+    nrf_hw_profile_dispatch(handle);
+  } else {
+    nrf_hw_timers_cb[handle]();
+  }
+  if ( coalesce ){
+    nrf_ppi_coalesce_end();
+  }
+}
+
+/*
+ * By default each call runs only the one timer which was due, and the time
+ * machine calls us again (in another delta cycle) for any other timer due at
+ * the same time.
+ * In batch dispatch mode all HW timers due at this time (including those
+ * re-armed for this same time by the handlers) are run in one go, in
+ * priority order.
+ * In both cases, the next timer is only re-evaluated (and the time machine
+ * notified) once at the end.
  */
-void nrf_hw_find_next_timer_to_trigger(){
+void nrf_hw_some_timer_reached() {
+  nrf_hw_sched_defer_begin();
+
+  if ( !nrf_hw_batch_dispatch ){
+    nrf_hw_timer_dispatch(nrf_hw_next_timer_to_trigger);
+  } else {
+    bs_time_t now = timer_nrf_main_timer;
+    do {
+      nrf_hw_timer_dispatch(nrf_hw_timers_tree[1]);
+    } while ( nrf_hw_timers[nrf_hw_timers_tree[1]] <= now );
+  }
+
+  nrf_hw_sched_defer_end();
+}
+
+#if defined(__TEST_NRF_HW_TIMERS_TREE)
+//Check the timers tree picks the same timer as the old linear scan, and benchmark both
+// gcc -O2 -ffunction-sections -Wl,--gc-sections -D__TEST_NRF_HW_TIMERS_TREE -I<bsim includes>
+//     NRF_HW_model_top.c -o timers_tree_test && ./timers_tree_test
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_N_TIMERS 15
+
+/*
+ * The old scheduler: each peripheral timer in its own global,
+ * scanned thru a table of pointers on every update
+ */
+static bs_time_t Timer_0, Timer_1, Timer_2, Timer_3, Timer_4, Timer_5, Timer_6, Timer_7,
+                 Timer_8, Timer_9, Timer_10, Timer_11, Timer_12, Timer_13, Timer_14;
+static bs_time_t *Timers[TEST_N_TIMERS] = {
+    &Timer_0, &Timer_1, &Timer_2, &Timer_3, &Timer_4, &Timer_5, &Timer_6, &Timer_7,
+    &Timer_8, &Timer_9, &Timer_10, &Timer_11, &Timer_12, &Timer_13, &Timer_14};
+
+static uint old_find_next_timer_to_trigger(void){
   bs_time_t new_timer = *Timers[0];
-  nrf_hw_next_timer_to_trigger = 0;
+  uint next = 0;
 
-  for (uint i = 1; i < NumberOfNRFHWTimers ; i++){
+  for (uint i = 1; i < TEST_N_TIMERS ; i++){
     if ( new_timer > *Timers[i] ) {
       new_timer = *Timers[i];
-      nrf_hw_next_timer_to_trigger = i;
+      next = i;
     }
   }
-  if ( new_timer != timer_nrf_main_timer ){
-    timer_nrf_main_timer = new_timer;
-    tm_find_next_timer_to_trigger();
-  }
+  return next;
 }
 
-void nrf_hw_some_timer_reached() {
+static double now_ns(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e9 + t.tv_nsec;
+}
 
-  switch ( nrf_hw_next_timer_to_trigger ) {
-  case fake_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: fake timer\n");
-    fake_timer_triggered();
-    break;
-  case fw_test_ticker:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: FW test ticker\n");
-    bst_ticker_triggered(timer_nrf_main_timer);
-    break;
-  case irq_ctrl_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: IRQ ctrl timer\n");
-    hw_irq_ctrl_timer_triggered();
-    break;
-  case RNG_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: RNG timer\n");
-    nrf_rng_timer_triggered();
-    break;
-  case TEMP_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: TEMP timer\n");
-    nrf_temp_timer_triggered();
-    break;
-  case NVMC_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: NVMC timer\n");
-    nrfhw_nvmc_timer_triggered();
-    break;
-  case ECB_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: ECB timer\n");
-    nrf_ecb_timer_triggered();
-    break;
-  case AAR_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: AAR timer\n");
-    nrf_aar_timer_triggered();
-    break;
-  case CLOCK_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: CLOCK timer\n");
-    nrf_clock_timer_triggered();
-    break;
-  case GPIO_input:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: GPIO input timer\n");
-    nrf_gpio_input_event_triggered();
-    break;
-  case RTC_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: RTC timer\n");
-    nrf_rtc_timer_triggered();
-    break;
-  case TIMER_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: TIMERx timer\n");
-    nrf_hw_model_timer_timer_triggered();
-    break;
-  case RADIO_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: RADIO timer\n");
-    nrf_radio_timer_triggered();
-    break;
-  case RADIO_bitcounter:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: RADIO bitcounter timer\n");
-    nrf_radio_bitcounter_timer_triggered();
-    break;
-  case RADIO_abort_reeval_timer:
-    bs_trace_raw_manual_time(8, tm_get_abs_time(),"NRF HW: RADIO abort reeval timer\n");
-    nrf_radio_timer_abort_reeval_triggered();
-    break;
-  default:
-    bs_trace_error_line("nrf_hw_next_timer_to_trigger corrupted\n");
-    break;
+int main(){
+  const int n_check = 2000000;
+  const int n_bench = 50000000;
+  uint *leaves = malloc(n_bench*sizeof(uint));
+  bs_time_t *times = malloc(n_bench*sizeof(bs_time_t));
+  volatile uint sink = 0;
+  int errors = 0;
+  double t0;
+
+  nrf_hw_n_timers = TEST_N_TIMERS;
+  nrf_hw_timers_tree_build();
+  for (uint i = 0; i < TEST_N_TIMERS; i++){
+    nrf_hw_timers[i] = TIME_NEVER;
+    nrf_hw_timers_tree_update(i);
+    *Timers[i] = TIME_NEVER;
+  }
+
+  //Few distinct times, so ties (decided by priority) are frequent
+  srand(0);
+  for (int i = 0; i < n_bench; i++){
+    leaves[i] = rand() % TEST_N_TIMERS;
+    times[i] = (rand() % 8 == 0) ? TIME_NEVER : (bs_time_t)(rand() % 64);
+  }
+
+  for (int i = 0; i < n_check; i++){
+    *Timers[leaves[i]] = times[i];
+    nrf_hw_timers[leaves[i]] = times[i];
+    nrf_hw_timers_tree_update(leaves[i]);
+    uint old = old_find_next_timer_to_trigger();
+    if ( old != nrf_hw_timers_tree[1] ){
+      if ( errors++ < 10 ){
+        printf("Update %i: scan picked %u, tree picked %u\n", i, old, nrf_hw_timers_tree[1]);
+      }
+    }
+  }
+
+  t0 = now_ns();
+  for (int i = 0; i < n_bench; i++){
+    *Timers[leaves[i]] = times[i];
+    sink += old_find_next_timer_to_trigger();
+  }
+  double t_scan = (now_ns() - t0)/n_bench;
+
+  t0 = now_ns();
+  for (int i = 0; i < n_bench; i++){
+    nrf_hw_timers[leaves[i]] = times[i];
+    nrf_hw_timers_tree_update(leaves[i]);
+    sink += nrf_hw_timers_tree[1];
+  }
+  double t_tree = (now_ns() - t0)/n_bench;
+
+  printf("%i timers, %i updates: linear scan %.1fns/op, tournament tree %.1fns/op\n",
+         TEST_N_TIMERS, n_bench, t_scan, t_tree);
+  free(leaves);
+  free(times);
+
+  if ( errors == 0 ){
+    printf("The tree picked the same timer in all %i updates -> PASSED\n", n_check);
+    return 0;
+  } else {
+    printf("The tree picked a different timer in %i updates -> FAILED\n", errors);
+    return 1;
   }
 }
+#endif //defined(__TEST_NRF_HW_TIMERS_TREE)
@@ -53,8 +53,86 @@ void nrf_hw_some_timer_reached();
  * Internal API to the HW models
  */
 
+//The events priorities are as in this enum from top to bottom
+// (priority == which executes if they have the same timing)
+typedef enum {
+  NRF_HW_TIMER_PRIO_FANOUT, //Before any other, so the children start from the state before this time
+  NRF_HW_TIMER_PRIO_FAKE_TIMER,
+  NRF_HW_TIMER_PRIO_FW_TEST_TICKER,
+  NRF_HW_TIMER_PRIO_IRQ_CTRL,
+  NRF_HW_TIMER_PRIO_RNG,
+  NRF_HW_TIMER_PRIO_TEMP,
+  NRF_HW_TIMER_PRIO_NVMC,
+  NRF_HW_TIMER_PRIO_ECB,
+  NRF_HW_TIMER_PRIO_AAR,
+  NRF_HW_TIMER_PRIO_CLOCK,
+  NRF_HW_TIMER_PRIO_GPIO_INPUT,
+  NRF_HW_TIMER_PRIO_RTC,
+  NRF_HW_TIMER_PRIO_TIMER,
+  NRF_HW_TIMER_PRIO_RADIO,
+  NRF_HW_TIMER_PRIO_RADIO_BITCOUNTER,
+  NRF_HW_TIMER_PRIO_RADIO_ABORT_REEVAL, //This timer should always be the latest in this list (lowest priority)
+  NRF_HW_TIMER_PRIO_NUMBER
+} nrf_hw_timer_prio_t;
+
+/*
+ * Maximum number of event timers which can be registered
+ */
+#define NRF_HW_MAX_TIMERS 16
+
+typedef int nrf_hw_timer_handle_t;
+typedef void (*nrf_hw_timer_cb_t)(void);
+
+/**
+ * Register a HW model event timer
+ *
+ * <name> is only used for tracing, <priority> decides which timer is
+ * dispatched first when several are due at the same time, and <callback>
+ * is called when the timer is reached.
+ * Timers start as TIME_NEVER, and are only added to the scheduling the first
+ * time they are set to another value, so registering a timer for a peripheral
+ * which ends up not being used costs nothing.
+ * Returns a handle to be used with nrf_hw_timer_update()
+ *
+ * To be called during the HW models initialization
+ */
+nrf_hw_timer_handle_t nrf_hw_timer_register(const char *name,
+                                            nrf_hw_timer_prio_t priority,
+                                            nrf_hw_timer_cb_t callback);
+
+/**
+ * Each time a HW peripheral model updates its event timer,
+ * it must notify the top level with its new value thru this function
+ */
+void nrf_hw_timer_update(nrf_hw_timer_handle_t timer, bs_time_t value);
+
+/**
+ * Open/close a deferred rescheduling bracket
+ *
+ * Inside a bracket, nrf_hw_find_next_timer_to_trigger() (and therefore
+ * nrf_hw_timer_update()) only mark the next timer as needing re-evaluation,
+ * which is then done once, when the outermost bracket is closed.
+ * Brackets can be nested, and must always be balanced.
+ * Note that inside a bracket, timer_nrf_main_timer is not updated.
+ */
+void nrf_hw_sched_defer_begin(void);
+void nrf_hw_sched_defer_end(void);
+
+/**
+ * Get how many times the next timer has been re-evaluated,
+ * and how many re-evaluations were avoided thanks to deferring them
+ */
+void nrf_hw_sched_get_stats(uint64_t *recomputes, uint64_t *recomputes_saved);
+
+/**
+ * To be called after the models state has been replaced (restored from a snapshot)
+ * to notify the overall scheduler of the next HW event timer
+ */
+void nrf_hw_snapshot_restored(void);
+
 /**
- * Each time a HW peripheral model
+ * Reevaluate which is the next HW event timer to trigger,
+ * and notify the overall scheduler if its time changed
  */
 void nrf_hw_find_next_timer_to_trigger();
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Snapshots (checkpoints) of the HW models state (see NRF_HW_snapshot.h)
+ *
+ * File format (host endianness, as it can only be restored by the same executable):
+ *   snapshot_header_t
+ *   The NRF_HW_STATE section content
+ *   Each model own additional data (in the order of nrf_hw_snapshot_save())
+ */
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "bs_tracing.h"
+#include "NRF_HW_snapshot.h"
+#include "NRF_HW_ctx.h"
+#include "NRF_HW_model_top.h"
+#include "NRF_NVMC.h"
+#include "NRF_GPIO_backend.h"
+#include "NRF_PPI.h"
+
+#define SNAPSHOT_MAGIC "NRFHWSS1"
+
+typedef struct {
+  char magic[8];
+  uint64_t state_addr; /* Address of the state section in the process which saved it */
+  uint64_t state_size;
+} snapshot_header_t;
+
+void nrf_hw_snapshot_write(int fd, const void *buf, size_t size){
+  const char *ptr = buf;
+
+  while (size > 0) {
+    ssize_t ret = write(fd, ptr, size);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      bs_trace_error_line("Failed to write HW models snapshot: %s\n", strerror(errno));
+    }
+    ptr += ret;
+    size -= ret;
+  }
+}
+
+void nrf_hw_snapshot_read(int fd, void *buf, size_t size){
+  char *ptr = buf;
+
+  while (size > 0) {
+    ssize_t ret = read(fd, ptr, size);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      bs_trace_error_line("Failed to read HW models snapshot: %s\n", strerror(errno));
+    } else if (ret == 0) {
+      bs_trace_error_line("HW models snapshot truncated\n");
+    }
+    ptr += ret;
+    size -= ret;
+  }
+}
+
+void nrf_hw_snapshot_save(int fd){
+  snapshot_header_t header;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.state_addr = (uintptr_t)nrf_hw_ctx_state_get();
+  header.state_size = nrf_hw_ctx_state_size();
+
+  nrf_hw_snapshot_write(fd, &header, sizeof(header));
+  nrf_hw_snapshot_write(fd, nrf_hw_ctx_state_get(), nrf_hw_ctx_state_size());
+  nrfhw_nvmc_snapshot_save(fd);
+  nrf_gpio_backend_snapshot_save(fd);
+}
+
+void nrf_hw_snapshot_restore(int fd){
+  snapshot_header_t header;
+
+  nrf_hw_snapshot_read(fd, &header, sizeof(header));
+
+  if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+    bs_trace_error_line("This is not a HW models snapshot (or of an incompatible version)\n");
+  }
+  if (header.state_size != nrf_hw_ctx_state_size()) {
+    bs_trace_error_line("HW models snapshot saved by a different executable "
+                        "(state size %"PRIu64" != %zu)\n",
+                        header.state_size, nrf_hw_ctx_state_size());
+  }
+  /* The registers hold pointers (PPI EEP/TEP, EasyDMA pointers to the SW
+   * RAM..), so the memory layout must be the same */
+  if (header.state_addr != (uintptr_t)nrf_hw_ctx_state_get()) {
+    bs_trace_error_line("HW models snapshot saved with a different memory layout "
+                        "(run with address space randomization disabled)\n");
+  }
+
+  nrf_hw_snapshot_read(fd, nrf_hw_ctx_state_get(), nrf_hw_ctx_state_size());
+  nrfhw_nvmc_snapshot_restore(fd);
+  nrf_gpio_backend_snapshot_restore(fd);
+  nrf_ppi_snapshot_restore();
+
+  nrf_hw_snapshot_restored();
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Snapshots (checkpoints) of the HW models state
+ *
+ * A snapshot contains the complete state of the active device (all
+ * NRF_HW_STATE variables, see NRF_HW_ctx.h), together with the flash and UICR
+ * contents and the position in the GPIO input file.
+ *
+ * A snapshot can only be restored by the same executable which saved it,
+ * after the models have been initialized normally (nrf_hw_pre_init() and
+ * nrf_hw_initialize()) with the same command line options.
+ * Restoring it replaces the models state, so the simulation continues
+ * exactly as it would have from the point in which it was saved.
+ *
+ * Note that only the HW models state is covered: The integrating program
+ * must save and restore the CPU/SW, the overall scheduler (time machine),
+ * and if used, the Phy, state at the same point.
+ * Snapshots should be taken between HW models events, not from within
+ * a HW model or SW register access.
+ */
+#ifndef _NRF_HW_SNAPSHOT_H
+#define _NRF_HW_SNAPSHOT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * Save the active device HW models state into the file descriptor <fd>
+ */
+void nrf_hw_snapshot_save(int fd);
+
+/*
+ * Restore the active device HW models state from the file descriptor <fd>
+ */
+void nrf_hw_snapshot_restore(int fd);
+
+/*
+ * Helpers for the models which need to save/restore more than their
+ * NRF_HW_STATE variables (errors out on failure)
+ */
+void nrf_hw_snapshot_write(int fd, const void *buf, size_t size);
+void nrf_hw_snapshot_read(int fd, void *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/*
+ * Wrappers for the bs_trace_raw*() debug traces used in the HW models hot paths
+ *
+ * Traces with a level above NRF_HW_TRACE_MAX_LEVEL are compiled out entirely
+ * (their arguments are not even evaluated).
+ * The rest are only called if the current verbosity would print them,
+ * which is checked inline, so the arguments are not evaluated and the
+ * tracing library is not called otherwise.
+ *
+ * Errors, warnings and info messages must still use bs_trace_* directly.
+ */
+#ifndef _NRF_HW_TRACE_H
+#define _NRF_HW_TRACE_H
+
+#include "bs_tracing.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * Maximum trace level which will be built in.
+ * Define it (for ex. to 2) in the build to remove all debug traces from the models
+ */
+#ifndef NRF_HW_TRACE_MAX_LEVEL
+#define NRF_HW_TRACE_MAX_LEVEL 9
+#endif
+
+/*
+ * Copy of the verbosity level of the tracing library.
+ * (It is updated in nrf_hw_initialize(), after the command line has been parsed)
+ */
+extern int nrf_hw_trace_level;
+
+void nrf_hw_trace_level_update(void);
+
+#define NRF_HW_TRACE_WILL_PRINT(level) \
+  (((level) <= NRF_HW_TRACE_MAX_LEVEL) && ((level) <= nrf_hw_trace_level))
+
+#define NRF_HW_TRACE_RAW(level, ...) \
+  do { \
+    if (NRF_HW_TRACE_WILL_PRINT(level)) { \
+      bs_trace_raw(level, __VA_ARGS__); \
+    } \
+  } while (0)
+
+#define NRF_HW_TRACE_RAW_TIME(level, ...) \
+  do { \
+    if (NRF_HW_TRACE_WILL_PRINT(level)) { \
+      bs_trace_raw_time(level, __VA_ARGS__); \
+    } \
+  } while (0)
+
+#define NRF_HW_TRACE_RAW_MANUAL_TIME(level, time, ...) \
+  do { \
+    if (NRF_HW_TRACE_WILL_PRINT(level)) { \
+      bs_trace_raw_manual_time(level, time, __VA_ARGS__); \
+    } \
+  } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -60,10 +60,13 @@
 #include "NRF_HW_model_top.h"
 #include "time_machine_if.h"
 #include "weak_stubs.h"
+#include "NRF_HW_ctx.h"
+#include "NRF_HW_snapshot.h"
 
-NRF_UICR_Type *NRF_UICR_regs_p;
-NRF_NVMC_Type NRF_NVMC_regs = {0};
-bs_time_t Timer_NVMC = TIME_NEVER; //Time when the next flash operation will be completed
+NRF_HW_STATE_LOCAL NRF_UICR_Type *NRF_UICR_regs_p;
+NRF_HW_STATE NRF_NVMC_Type NRF_NVMC_regs = {0};
+NRF_HW_STATE bs_time_t Timer_NVMC = TIME_NEVER; //Time when the next flash operation will be completed
+static NRF_HW_STATE nrf_hw_timer_handle_t NVMC_timer;
 
 typedef struct {
   uint8_t *storage;
@@ -76,17 +79,17 @@ typedef struct {
   bool in_ram;
 } storage_state_t;
 
-static storage_state_t flash_st;
-static storage_state_t uicr_st;
-static enum flash_op_t {flash_idle = 0, flash_write, flash_erase, flash_erase_partial, flash_erase_uicr, flash_erase_all} flash_op;
-static uint32_t erase_address;
-static bs_time_t time_under_erase[FLASH_N_PAGES];
-static bool page_erased[FLASH_N_PAGES];
+static NRF_HW_STATE_LOCAL storage_state_t flash_st;
+static NRF_HW_STATE_LOCAL storage_state_t uicr_st;
+static NRF_HW_STATE enum flash_op_t {flash_idle = 0, flash_write, flash_erase, flash_erase_partial, flash_erase_uicr, flash_erase_all} flash_op;
+static NRF_HW_STATE uint32_t erase_address;
+static NRF_HW_STATE bs_time_t time_under_erase[FLASH_N_PAGES];
+static NRF_HW_STATE bool page_erased[FLASH_N_PAGES];
 
-static bs_time_t flash_t_eraseall  = 173000;
-static bs_time_t flash_t_erasepage =  87500;
-static bs_time_t flash_t_write     =     42;
-static double    flash_partial_erase_factor = 1.0; //actual tERASEPAGEPARTIAL,acc for this given device
+static NRF_HW_STATE bs_time_t flash_t_eraseall  = 173000;
+static NRF_HW_STATE bs_time_t flash_t_erasepage =  87500;
+static NRF_HW_STATE bs_time_t flash_t_write     =     42;
+static NRF_HW_STATE double    flash_partial_erase_factor = 1.0; //actual tERASEPAGEPARTIAL,acc for this given device
 
 struct nvmc_args_t {
   char *uicr_file;
@@ -112,6 +115,8 @@ void nrfhw_nvmc_uicr_pre_init(void){
  * Initialize the NVMC and UICR models
  */
 void nrfhw_nvmc_uicr_init(){
+  NVMC_timer = nrf_hw_timer_register("NVMC timer", NRF_HW_TIMER_PRIO_NVMC, nrfhw_nvmc_timer_triggered);
+
   memset(&NRF_NVMC_regs, 0x00, sizeof(NRF_NVMC_regs));
   NRF_NVMC_regs.READY = 1;
   NRF_NVMC_regs.READYNEXT = 1;
@@ -119,7 +124,7 @@ void nrfhw_nvmc_uicr_init(){
 
   flash_op = flash_idle;
   Timer_NVMC = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
 
   flash_st.file_path      = nvmc_args.flash_file;
   flash_st.erase_at_start = nvmc_args.flash_erase;
@@ -165,6 +170,61 @@ void nrfhw_nvmc_uicr_clean_up(){
   nvmc_clear_storage(&uicr_st);
 }
 
+static void nvmc_snapshot_save_storage(int fd, storage_state_t *st){
+  uint64_t size = st->size;
+  nrf_hw_snapshot_write(fd, &size, sizeof(size));
+  nrf_hw_snapshot_write(fd, st->storage, st->size);
+}
+
+static void nvmc_snapshot_restore_storage(int fd, storage_state_t *st){
+  uint64_t size;
+  nrf_hw_snapshot_read(fd, &size, sizeof(size));
+  if (size != st->size) {
+    bs_trace_error_line("%s: %s size in snapshot (%"PRIu64") does not match (%zu)\n",
+                        __func__, st->type_s, size, st->size);
+  }
+  nrf_hw_snapshot_read(fd, st->storage, st->size);
+}
+
+/**
+ * Save/restore the flash and UICR contents into/from a snapshot
+ * (the rest of the NVMC state is in the snapshot NRF_HW_STATE part)
+ */
+void nrfhw_nvmc_snapshot_save(int fd){
+  nvmc_snapshot_save_storage(fd, &flash_st);
+  nvmc_snapshot_save_storage(fd, &uicr_st);
+}
+
+void nrfhw_nvmc_snapshot_restore(int fd){
+  nvmc_snapshot_restore_storage(fd, &flash_st);
+  nvmc_snapshot_restore_storage(fd, &uicr_st);
+}
+
+static void nvmc_fanout_child_storage(storage_state_t *st){
+  if (st->in_ram == true) { /* Already a copy-on-write copy of the parent's heap */
+    return;
+  }
+  /* Replace the shared mapping with a private one, at the same address */
+  void *storage = mmap(st->storage, st->size, PROT_WRITE | PROT_READ,
+                       MAP_PRIVATE | MAP_FIXED, st->fd, 0);
+  if (storage == MAP_FAILED) {
+    bs_trace_error_line("%s: Failed to remap %s device file %s: %s\n",
+        __func__, st->type_s, st->file_path, strerror(errno));
+  }
+  /* The file still belongs to the parent */
+  st->rm_at_exit = false;
+}
+
+/**
+ * In a fan-out child process (see NRF_HW_fanout.h), detach the flash and UICR
+ * from their files, so the changes of this child are private to it,
+ * and neither reach the files nor the other children
+ */
+void nrfhw_nvmc_fanout_child(void){
+  nvmc_fanout_child_storage(&flash_st);
+  nvmc_fanout_child_storage(&uicr_st);
+}
+
 /*
  * Complete the actual erase of a flash page
  */
@@ -238,7 +298,7 @@ void nrfhw_nvmc_timer_triggered(void){
   NRF_NVMC_regs.READYNEXT = 1;
 
   Timer_NVMC = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
 }
 
 bs_time_t nrfhw_nvmc_time_to_ready(void) {
@@ -305,7 +365,7 @@ static void nrfhw_nvmc_erase_page(uint32_t address){
   NRF_NVMC_regs.READYNEXT = 0;
   erase_address = address;
   Timer_NVMC = tm_get_hw_time() + flash_t_erasepage;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
 }
 
 /* Note ERASEPCR1 is an alias to ERASEPAGE (same register) */
@@ -328,7 +388,7 @@ void nrfhw_nvmc_regw_sideeffects_ERASEUICR(){
     NRF_NVMC_regs.READY = 0;
     NRF_NVMC_regs.READYNEXT = 0;
     Timer_NVMC = tm_get_hw_time() + flash_t_erasepage;
-    nrf_hw_find_next_timer_to_trigger();
+    nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
   }
 }
 
@@ -343,7 +403,7 @@ void nrfhw_nvmc_regw_sideeffects_ERASEALL(){
     NRF_NVMC_regs.READY = 0;
     NRF_NVMC_regs.READYNEXT = 0;
     Timer_NVMC = tm_get_hw_time() + flash_t_eraseall;
-    nrf_hw_find_next_timer_to_trigger();
+    nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
   }
 }
 
@@ -362,7 +422,7 @@ void nrfhw_nvmc_regw_sideeffects_ERASEPAGEPARTIAL(){
     time_under_erase[erase_address/FLASH_PAGE_SIZE] += duration;
   }
   Timer_NVMC = tm_get_hw_time() + duration;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
 }
 
 static bool addr_in_uicr(uint32_t address){
@@ -407,7 +467,7 @@ void nrfhw_nmvc_write_word(uint32_t address, uint32_t value){
   NRF_NVMC_regs.READYNEXT = 0;
 
   Timer_NVMC = tm_get_hw_time() + flash_t_write;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(NVMC_timer, Timer_NVMC);
 }
 
 /**
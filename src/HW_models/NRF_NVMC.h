@@ -39,6 +39,9 @@ uint8_t nrfhw_nmvc_read_byte(uint32_t address);
 void nrfhw_nmvc_read_buffer(void *dest, uint32_t address, size_t size);
 void* nrfhw_nmvc_flash_get_base_address(void);
 bs_time_t nrfhw_nvmc_time_to_ready(void);
+void nrfhw_nvmc_snapshot_save(int fd);
+void nrfhw_nvmc_snapshot_restore(int fd);
+void nrfhw_nvmc_fanout_child(void);
 
 #ifdef __cplusplus
 }
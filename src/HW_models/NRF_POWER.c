@@ -10,5 +10,6 @@
  */
 
 #include "NRF_POWER.h"
+#include "NRF_HW_ctx.h"
 
-NRF_POWER_Type NRF_POWER_regs = {0};
+NRF_HW_STATE NRF_POWER_Type NRF_POWER_regs = {0};
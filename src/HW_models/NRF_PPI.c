@@ -13,11 +13,17 @@
  *
  *   * In the real PPI, if two separate events which trigger the same task come close enough to each other
  *     (they are registered by the same 16MHz clock edge), that common task will only be triggered once.
- *     In this model, such events would cause such a tasks to trigger twice.
+ *     This model cannot tell 16MHz clock edges apart, so instead, while a peripheral model is handling one of
+ *     its timers (see nrf_hw_timer_dispatch()), a task is triggered only by the first event which reaches it
+ *     (see nrf_ppi_coalesce_begin()).
+ *     Tasks are still triggered right away when the event is raised, that is, before the shorts of the model
+ *     which raised it (for ex. RADIO READY -> CCM KSGEN/CRYPT before the READY_START short starts the Tx).
+ *     The SW (ISRs included) never runs inside this window, so tasks it triggers are never dropped.
  */
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "time_machine_if.h"
 #include "NRF_HW_model_top.h"
@@ -33,18 +39,20 @@
 #include "NRF_EGU.h"
 #include "bs_tracing.h"
 #include "bs_oswrap.h"
+#include "NRF_HW_trace.h"
+#include "NRF_HW_ctx.h"
 
-NRF_PPI_Type NRF_PPI_regs; ///< The PPI registers
+NRF_HW_STATE NRF_PPI_Type NRF_PPI_regs; ///< The PPI registers
 
 /**
  * PPI module own TASKs handlers
  */
 void nrf_ppi_TASK_CHG_ENDIS( int groupnbr, bool enable /*false=disable task*/ ){
   if ( enable ){
-    bs_trace_raw_time(9, "ppi: Channel group %i enabled\n", groupnbr);
+    NRF_HW_TRACE_RAW_TIME(9, "ppi: Channel group %i enabled\n", groupnbr);
     NRF_PPI_regs.CHEN |= NRF_PPI_regs.CHG[groupnbr];
   } else {
-    bs_trace_raw_time(9 ,"ppi: Channel group %i disable\n", groupnbr);
+    NRF_HW_TRACE_RAW_TIME(9,"ppi: Channel group %i disable\n", groupnbr);
     NRF_PPI_regs.CHEN &= ~NRF_PPI_regs.CHG[groupnbr];
   }
   //Note of the author: From the spec I cannot guess if these tasks will affect
@@ -64,53 +72,91 @@ void nrf_ppi_TASK_CHG4_DIS(){ nrf_ppi_TASK_CHG_ENDIS(4,false); }
 void nrf_ppi_TASK_CHG5_DIS(){ nrf_ppi_TASK_CHG_ENDIS(5,false); }
 
 typedef void (*dest_f_t)(void); ///<Syntactic sugar for task function pointer
+///Task of one of the instances of a peripheral (e.g. TIMER<inst> START)
+typedef void (*dest_inst_f_t)(int inst);
+///Task <idx> of one of the instances of a peripheral (e.g. TIMER<inst> CAPTURE[idx])
+typedef void (*dest_inst_idx_f_t)(int inst, int idx);
 
 typedef struct{
   uint32_t channels_mask; //bitmask indicating which channel the event is mapped to
 } ppi_event_to_ch_t;
 ///Table contain which channels each event is activating (one entry per event)
-static ppi_event_to_ch_t ppi_evt_to_ch[NUMBER_PPI_EVENTS];
+static NRF_HW_STATE ppi_event_to_ch_t ppi_evt_to_ch[NUMBER_PPI_EVENTS];
+///Reverse of ppi_evt_to_ch: which event feeds each channel (NUMBER_PPI_EVENTS if none)
+static NRF_HW_STATE ppi_event_types_t ppi_ch_to_evt[NUMBER_PPI_CHANNELS];
+
+/*
+ * Tasks are identified by their index in ppi_tasks_table + 1
+ * (0 meaning no task)
+ */
+typedef uint16_t ppi_task_id_t;
+#define PPI_NO_TASK 0
 
 typedef struct {
-  dest_f_t tep_f;
-  dest_f_t fork_tep_f;
+  ppi_task_id_t tep;
+  ppi_task_id_t fork_tep;
 } ppi_channel_tasks_t;
 ///Table with TASKs each channel activates
-static ppi_channel_tasks_t ppi_ch_tasks[NUMBER_PPI_CHANNELS];
+static NRF_HW_STATE_LOCAL ppi_channel_tasks_t ppi_ch_tasks[NUMBER_PPI_CHANNELS];
 
 typedef struct {
   void *task_addr;
-  dest_f_t dest; //function to be called when task is triggered
+  //function to be called when task is triggered (only one of them is set)
+  dest_f_t dest;
+  dest_inst_f_t dest_inst; //called with <inst>
+  dest_inst_idx_f_t dest_inst_idx; //called with <inst> and <idx>
+  uint8_t inst;
+  uint8_t idx;
+  const char *name; //Only for the routing dump
 } ppi_tasks_table_t;
 
 /**
  * Table of TASKs addresses (as provided by the SW) vs the model function
  * pointer (which handles the task trigger)
+ * <reg> is the task register itself, whose name is also kept
  */
+#define PPI_TASK(reg, f) \
+    { .task_addr = (void*)&(reg), .dest = f, .name = #reg },
+#define PPI_TASK_INST(reg, f, i) \
+    { .task_addr = (void*)&(reg), .dest_inst = f, .inst = i, .name = #reg },
+#define PPI_TASK_INST_IDX(reg, f, i, n) \
+    { .task_addr = (void*)&(reg), .dest_inst_idx = f, .inst = i, .idx = n, .name = #reg },
+
+#define PPI_TIMER_CAPTURE_TASK(t, cc) \
+    PPI_TASK_INST_IDX(NRF_TIMER_regs[t].TASKS_CAPTURE[cc], nrf_timer_TASK_CAPTURE, t, cc)
+#define PPI_TIMER_TASKS(t) \
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_CAPTURE_TASK, t) \
+    PPI_TASK_INST(NRF_TIMER_regs[t].TASKS_CLEAR, nrf_timer_TASK_CLEAR, t) \
+    PPI_TASK_INST(NRF_TIMER_regs[t].TASKS_COUNT, nrf_timer_TASK_COUNT, t) \
+    PPI_TASK_INST(NRF_TIMER_regs[t].TASKS_START, nrf_timer_TASK_START, t) \
+    PPI_TASK_INST(NRF_TIMER_regs[t].TASKS_STOP,  nrf_timer_TASK_STOP,  t)
+#define PPI_EGU_TASK(inst, n) \
+    PPI_TASK_INST_IDX(NRF_EGU_regs[inst].TASKS_TRIGGER[n], nrf_egu_TASK_TRIGGER, inst, n)
+
 static const ppi_tasks_table_t ppi_tasks_table[]={ //just the ones we may use
     //POWER CLOCK:
-    { (void*)&NRF_CLOCK_regs.TASKS_LFCLKSTART , nrf_clock_TASKS_LFCLKSTART},
-    { (void*)&NRF_CLOCK_regs.TASKS_LFCLKSTOP  , nrf_clock_TASKS_LFCLKSTOP},
-    { (void*)&NRF_CLOCK_regs.TASKS_HFCLKSTART , nrf_clock_TASKS_HFCLKSTART},
-    { (void*)&NRF_CLOCK_regs.TASKS_HFCLKSTOP  , nrf_clock_TASKS_HFCLKSTOP},
-    { (void*)&NRF_CLOCK_regs.TASKS_CAL        , nrf_clock_TASKS_CAL},
-    { (void*)&NRF_CLOCK_regs.TASKS_CTSTART    , nrf_clock_TASKS_CTSTART},
-    { (void*)&NRF_CLOCK_regs.TASKS_CTSTOP     , nrf_clock_TASKS_CTSTOP},
+    PPI_TASK(NRF_CLOCK_regs.TASKS_LFCLKSTART, nrf_clock_TASKS_LFCLKSTART)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_LFCLKSTOP, nrf_clock_TASKS_LFCLKSTOP)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_HFCLKSTART, nrf_clock_TASKS_HFCLKSTART)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_HFCLKSTOP, nrf_clock_TASKS_HFCLKSTOP)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_CAL, nrf_clock_TASKS_CAL)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_CTSTART, nrf_clock_TASKS_CTSTART)
+    PPI_TASK(NRF_CLOCK_regs.TASKS_CTSTOP, nrf_clock_TASKS_CTSTOP)
 
     //RADIO:
-    { (void*)&NRF_RADIO_regs.TASKS_TXEN,         nrf_radio_tasks_TXEN},
-    { (void*)&NRF_RADIO_regs.TASKS_RXEN,         nrf_radio_tasks_RXEN},
-    { (void*)&NRF_RADIO_regs.TASKS_START,        nrf_radio_tasks_START},
-    { (void*)&NRF_RADIO_regs.TASKS_STOP,         nrf_radio_tasks_STOP},
-    { (void*)&NRF_RADIO_regs.TASKS_DISABLE,      nrf_radio_tasks_DISABLE},
-    { (void*)&NRF_RADIO_regs.TASKS_RSSISTART,    nrf_radio_tasks_RSSISTART},
-    { (void*)&NRF_RADIO_regs.TASKS_RSSISTOP,     nrf_radio_tasks_RSSISTOP},
-    { (void*)&NRF_RADIO_regs.TASKS_BCSTART,      nrf_radio_tasks_BCSTART},
-    { (void*)&NRF_RADIO_regs.TASKS_BCSTOP,       nrf_radio_tasks_BCSTOP},
-    { (void*)&NRF_RADIO_regs.TASKS_EDSTART,      nrf_radio_tasks_EDSTART},
-    { (void*)&NRF_RADIO_regs.TASKS_EDSTOP,       nrf_radio_tasks_EDSTOP},
-    { (void*)&NRF_RADIO_regs.TASKS_CCASTART,     nrf_radio_tasks_CCASTART},
-    { (void*)&NRF_RADIO_regs.TASKS_CCASTOP,      nrf_radio_tasks_CCASTOP},
+    PPI_TASK(NRF_RADIO_regs.TASKS_TXEN, nrf_radio_tasks_TXEN)
+    PPI_TASK(NRF_RADIO_regs.TASKS_RXEN, nrf_radio_tasks_RXEN)
+    PPI_TASK(NRF_RADIO_regs.TASKS_START, nrf_radio_tasks_START)
+    PPI_TASK(NRF_RADIO_regs.TASKS_STOP, nrf_radio_tasks_STOP)
+    PPI_TASK(NRF_RADIO_regs.TASKS_DISABLE, nrf_radio_tasks_DISABLE)
+    PPI_TASK(NRF_RADIO_regs.TASKS_RSSISTART, nrf_radio_tasks_RSSISTART)
+    PPI_TASK(NRF_RADIO_regs.TASKS_RSSISTOP, nrf_radio_tasks_RSSISTOP)
+    PPI_TASK(NRF_RADIO_regs.TASKS_BCSTART, nrf_radio_tasks_BCSTART)
+    PPI_TASK(NRF_RADIO_regs.TASKS_BCSTOP, nrf_radio_tasks_BCSTOP)
+    PPI_TASK(NRF_RADIO_regs.TASKS_EDSTART, nrf_radio_tasks_EDSTART)
+    PPI_TASK(NRF_RADIO_regs.TASKS_EDSTOP, nrf_radio_tasks_EDSTOP)
+    PPI_TASK(NRF_RADIO_regs.TASKS_CCASTART, nrf_radio_tasks_CCASTART)
+    PPI_TASK(NRF_RADIO_regs.TASKS_CCASTOP, nrf_radio_tasks_CCASTOP)
     //UART
     //SPI0
     //TWI0
@@ -119,88 +165,35 @@ static const ppi_tasks_table_t ppi_tasks_table[]={ //just the ones we may use
     //NFCT
 
     //GPIOTE
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[0],  nrf_gpiote_TASKS_OUT_0},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[1],  nrf_gpiote_TASKS_OUT_1},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[2],  nrf_gpiote_TASKS_OUT_2},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[3],  nrf_gpiote_TASKS_OUT_3},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[4],  nrf_gpiote_TASKS_OUT_4},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[5],  nrf_gpiote_TASKS_OUT_5},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[6],  nrf_gpiote_TASKS_OUT_6},
-    { (void*)&NRF_GPIOTE_regs.TASKS_OUT[7],  nrf_gpiote_TASKS_OUT_7},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[0],  nrf_gpiote_TASKS_SET_0},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[1],  nrf_gpiote_TASKS_SET_1},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[2],  nrf_gpiote_TASKS_SET_2},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[3],  nrf_gpiote_TASKS_SET_3},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[4],  nrf_gpiote_TASKS_SET_4},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[5],  nrf_gpiote_TASKS_SET_5},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[6],  nrf_gpiote_TASKS_SET_6},
-    { (void*)&NRF_GPIOTE_regs.TASKS_SET[7],  nrf_gpiote_TASKS_SET_7},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[0],  nrf_gpiote_TASKS_CLR_0},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[1],  nrf_gpiote_TASKS_CLR_1},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[2],  nrf_gpiote_TASKS_CLR_2},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[3],  nrf_gpiote_TASKS_CLR_3},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[4],  nrf_gpiote_TASKS_CLR_4},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[5],  nrf_gpiote_TASKS_CLR_5},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[6],  nrf_gpiote_TASKS_CLR_6},
-    { (void*)&NRF_GPIOTE_regs.TASKS_CLR[7],  nrf_gpiote_TASKS_CLR_7},
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[0], nrf_gpiote_TASKS_OUT_0)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[1], nrf_gpiote_TASKS_OUT_1)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[2], nrf_gpiote_TASKS_OUT_2)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[3], nrf_gpiote_TASKS_OUT_3)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[4], nrf_gpiote_TASKS_OUT_4)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[5], nrf_gpiote_TASKS_OUT_5)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[6], nrf_gpiote_TASKS_OUT_6)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_OUT[7], nrf_gpiote_TASKS_OUT_7)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[0], nrf_gpiote_TASKS_SET_0)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[1], nrf_gpiote_TASKS_SET_1)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[2], nrf_gpiote_TASKS_SET_2)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[3], nrf_gpiote_TASKS_SET_3)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[4], nrf_gpiote_TASKS_SET_4)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[5], nrf_gpiote_TASKS_SET_5)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[6], nrf_gpiote_TASKS_SET_6)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_SET[7], nrf_gpiote_TASKS_SET_7)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[0], nrf_gpiote_TASKS_CLR_0)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[1], nrf_gpiote_TASKS_CLR_1)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[2], nrf_gpiote_TASKS_CLR_2)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[3], nrf_gpiote_TASKS_CLR_3)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[4], nrf_gpiote_TASKS_CLR_4)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[5], nrf_gpiote_TASKS_CLR_5)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[6], nrf_gpiote_TASKS_CLR_6)
+    PPI_TASK(NRF_GPIOTE_regs.TASKS_CLR[7], nrf_gpiote_TASKS_CLR_7)
 
     //SAADC
 
-    //TIMER0:
-    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[0],  nrf_timer0_TASK_CAPTURE_0},
-    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[1],  nrf_timer0_TASK_CAPTURE_1},
-    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[2],  nrf_timer0_TASK_CAPTURE_2},
-    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[3],  nrf_timer0_TASK_CAPTURE_3},
-//    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[4],  nrf_timer0_TASK_CAPTURE_4},
-//    { (void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[5],  nrf_timer0_TASK_CAPTURE_5},
-    { (void*)&NRF_TIMER_regs[0].TASKS_CLEAR,       nrf_timer0_TASK_CLEAR},
-    { (void*)&NRF_TIMER_regs[0].TASKS_COUNT,       nrf_timer0_TASK_COUNT},
-    { (void*)&NRF_TIMER_regs[0].TASKS_START,       nrf_timer0_TASK_START},
-    { (void*)&NRF_TIMER_regs[0].TASKS_STOP,        nrf_timer0_TASK_STOP},
-    //TIMER1:
-    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[0],  nrf_timer1_TASK_CAPTURE_0},
-    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[1],  nrf_timer1_TASK_CAPTURE_1},
-    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[2],  nrf_timer1_TASK_CAPTURE_2},
-    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[3],  nrf_timer1_TASK_CAPTURE_3},
-//    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[4],  nrf_timer1_TASK_CAPTURE_4},
-//    { (void*)&NRF_TIMER_regs[1].TASKS_CAPTURE[5],  nrf_timer1_TASK_CAPTURE_5},
-    { (void*)&NRF_TIMER_regs[1].TASKS_CLEAR,       nrf_timer1_TASK_CLEAR},
-    { (void*)&NRF_TIMER_regs[1].TASKS_COUNT,       nrf_timer1_TASK_COUNT},
-    { (void*)&NRF_TIMER_regs[1].TASKS_START,       nrf_timer1_TASK_START},
-    { (void*)&NRF_TIMER_regs[1].TASKS_STOP,        nrf_timer1_TASK_STOP},
-    //TIMER2:
-    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[0],  nrf_timer2_TASK_CAPTURE_0},
-    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[1],  nrf_timer2_TASK_CAPTURE_1},
-    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[2],  nrf_timer2_TASK_CAPTURE_2},
-    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[3],  nrf_timer2_TASK_CAPTURE_3},
-//    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[4],  nrf_timer2_TASK_CAPTURE_4},
-//    { (void*)&NRF_TIMER_regs[2].TASKS_CAPTURE[5],  nrf_timer2_TASK_CAPTURE_5},
-    { (void*)&NRF_TIMER_regs[2].TASKS_CLEAR,       nrf_timer2_TASK_CLEAR},
-    { (void*)&NRF_TIMER_regs[2].TASKS_COUNT,       nrf_timer2_TASK_COUNT},
-    { (void*)&NRF_TIMER_regs[2].TASKS_START,       nrf_timer2_TASK_START},
-    { (void*)&NRF_TIMER_regs[2].TASKS_STOP,        nrf_timer2_TASK_STOP},
-    //TIMER3:
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[0],  nrf_timer3_TASK_CAPTURE_0},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[1],  nrf_timer3_TASK_CAPTURE_1},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[2],  nrf_timer3_TASK_CAPTURE_2},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[3],  nrf_timer3_TASK_CAPTURE_3},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[4],  nrf_timer3_TASK_CAPTURE_4},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CAPTURE[5],  nrf_timer3_TASK_CAPTURE_5},
-    { (void*)&NRF_TIMER_regs[3].TASKS_CLEAR,       nrf_timer3_TASK_CLEAR},
-    { (void*)&NRF_TIMER_regs[3].TASKS_COUNT,       nrf_timer3_TASK_COUNT},
-    { (void*)&NRF_TIMER_regs[3].TASKS_START,       nrf_timer3_TASK_START},
-    { (void*)&NRF_TIMER_regs[3].TASKS_STOP,        nrf_timer3_TASK_STOP},
-    //TIMER4:
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[0],  nrf_timer4_TASK_CAPTURE_0},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[1],  nrf_timer4_TASK_CAPTURE_1},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[2],  nrf_timer4_TASK_CAPTURE_2},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[3],  nrf_timer4_TASK_CAPTURE_3},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[4],  nrf_timer4_TASK_CAPTURE_4},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CAPTURE[5],  nrf_timer4_TASK_CAPTURE_5},
-    { (void*)&NRF_TIMER_regs[4].TASKS_CLEAR,       nrf_timer4_TASK_CLEAR},
-    { (void*)&NRF_TIMER_regs[4].TASKS_COUNT,       nrf_timer4_TASK_COUNT},
-    { (void*)&NRF_TIMER_regs[4].TASKS_START,       nrf_timer4_TASK_START},
-    { (void*)&NRF_TIMER_regs[4].TASKS_STOP,        nrf_timer4_TASK_STOP},
+    //TIMER:
+    NRF_TIMER_FOR_EACH_INST(PPI_TIMER_TASKS)
 
     //RTC:
     //{ (void*)&(NRF_RTC_regs[0]).TASKS_CLEAR, nrf_rtc0_TASKS_CLEAR},
@@ -217,128 +210,34 @@ static const ppi_tasks_table_t ppi_tasks_table[]={ //just the ones we may use
     //{ (void*)&(NRF_RTC_regs[2]).TASKS_TRIGOVRFLW , nrf_rtc2_TASKS_TRIGOVRFLW},
 
     //RNG:
-    { (void*)&NRF_RNG_regs.TASKS_START, nrf_rng_task_start},
-    { (void*)&NRF_RNG_regs.TASKS_STOP , nrf_rng_task_stop},
+    PPI_TASK(NRF_RNG_regs.TASKS_START, nrf_rng_task_start)
+    PPI_TASK(NRF_RNG_regs.TASKS_STOP, nrf_rng_task_stop)
 
     //ECB
 
     //AAR
-    { (void*)&NRF_AAR_regs.TASKS_START , nrf_aar_TASK_START},
+    PPI_TASK(NRF_AAR_regs.TASKS_START, nrf_aar_TASK_START)
 
     //CCM
-    { (void*)&NRF_CCM_regs.TASKS_CRYPT , nrf_ccm_TASK_CRYPT},
+    PPI_TASK(NRF_CCM_regs.TASKS_KSGEN, nrf_ccm_TASK_KSGEN)
+    PPI_TASK(NRF_CCM_regs.TASKS_CRYPT, nrf_ccm_TASK_CRYPT)
 
     //PPI:
-    { (void*)&NRF_PPI_regs.TASKS_CHG[0].EN,  nrf_ppi_TASK_CHG0_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[1].EN,  nrf_ppi_TASK_CHG1_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[2].EN,  nrf_ppi_TASK_CHG2_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[3].EN,  nrf_ppi_TASK_CHG3_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[4].EN,  nrf_ppi_TASK_CHG4_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[5].EN,  nrf_ppi_TASK_CHG5_EN},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[0].DIS, nrf_ppi_TASK_CHG0_DIS},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[1].DIS, nrf_ppi_TASK_CHG1_DIS},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[2].DIS, nrf_ppi_TASK_CHG2_DIS},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[3].DIS, nrf_ppi_TASK_CHG3_DIS},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[4].DIS, nrf_ppi_TASK_CHG4_DIS},
-    { (void*)&NRF_PPI_regs.TASKS_CHG[5].DIS, nrf_ppi_TASK_CHG5_DIS},
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[0].EN, nrf_ppi_TASK_CHG0_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[1].EN, nrf_ppi_TASK_CHG1_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[2].EN, nrf_ppi_TASK_CHG2_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[3].EN, nrf_ppi_TASK_CHG3_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[4].EN, nrf_ppi_TASK_CHG4_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[5].EN, nrf_ppi_TASK_CHG5_EN)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[0].DIS, nrf_ppi_TASK_CHG0_DIS)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[1].DIS, nrf_ppi_TASK_CHG1_DIS)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[2].DIS, nrf_ppi_TASK_CHG2_DIS)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[3].DIS, nrf_ppi_TASK_CHG3_DIS)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[4].DIS, nrf_ppi_TASK_CHG4_DIS)
+    PPI_TASK(NRF_PPI_regs.TASKS_CHG[5].DIS, nrf_ppi_TASK_CHG5_DIS)
 
     //EGU:
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[0] , nrf_egu_0_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[1] , nrf_egu_0_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[2] , nrf_egu_0_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[3] , nrf_egu_0_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[4] , nrf_egu_0_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[5] , nrf_egu_0_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[6] , nrf_egu_0_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[7] , nrf_egu_0_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[8] , nrf_egu_0_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[9] , nrf_egu_0_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[10] , nrf_egu_0_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[11] , nrf_egu_0_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[12] , nrf_egu_0_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[13] , nrf_egu_0_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[14] , nrf_egu_0_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[0].TASKS_TRIGGER[15] , nrf_egu_0_TASK_TRIGGER_15},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[0] , nrf_egu_1_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[1] , nrf_egu_1_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[2] , nrf_egu_1_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[3] , nrf_egu_1_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[4] , nrf_egu_1_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[5] , nrf_egu_1_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[6] , nrf_egu_1_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[7] , nrf_egu_1_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[8] , nrf_egu_1_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[9] , nrf_egu_1_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[10] , nrf_egu_1_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[11] , nrf_egu_1_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[12] , nrf_egu_1_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[13] , nrf_egu_1_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[14] , nrf_egu_1_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[1].TASKS_TRIGGER[15] , nrf_egu_1_TASK_TRIGGER_15},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[0] , nrf_egu_2_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[1] , nrf_egu_2_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[2] , nrf_egu_2_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[3] , nrf_egu_2_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[4] , nrf_egu_2_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[5] , nrf_egu_2_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[6] , nrf_egu_2_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[7] , nrf_egu_2_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[8] , nrf_egu_2_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[9] , nrf_egu_2_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[10] , nrf_egu_2_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[11] , nrf_egu_2_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[12] , nrf_egu_2_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[13] , nrf_egu_2_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[14] , nrf_egu_2_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[2].TASKS_TRIGGER[15] , nrf_egu_2_TASK_TRIGGER_15},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[0] , nrf_egu_3_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[1] , nrf_egu_3_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[2] , nrf_egu_3_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[3] , nrf_egu_3_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[4] , nrf_egu_3_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[5] , nrf_egu_3_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[6] , nrf_egu_3_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[7] , nrf_egu_3_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[8] , nrf_egu_3_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[9] , nrf_egu_3_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[10] , nrf_egu_3_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[11] , nrf_egu_3_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[12] , nrf_egu_3_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[13] , nrf_egu_3_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[14] , nrf_egu_3_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[3].TASKS_TRIGGER[15] , nrf_egu_3_TASK_TRIGGER_15},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[0] , nrf_egu_4_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[1] , nrf_egu_4_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[2] , nrf_egu_4_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[3] , nrf_egu_4_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[4] , nrf_egu_4_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[5] , nrf_egu_4_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[6] , nrf_egu_4_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[7] , nrf_egu_4_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[8] , nrf_egu_4_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[9] , nrf_egu_4_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[10] , nrf_egu_4_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[11] , nrf_egu_4_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[12] , nrf_egu_4_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[13] , nrf_egu_4_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[14] , nrf_egu_4_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[4].TASKS_TRIGGER[15] , nrf_egu_4_TASK_TRIGGER_15},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[0] , nrf_egu_5_TASK_TRIGGER_0},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[1] , nrf_egu_5_TASK_TRIGGER_1},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[2] , nrf_egu_5_TASK_TRIGGER_2},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[3] , nrf_egu_5_TASK_TRIGGER_3},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[4] , nrf_egu_5_TASK_TRIGGER_4},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[5] , nrf_egu_5_TASK_TRIGGER_5},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[6] , nrf_egu_5_TASK_TRIGGER_6},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[7] , nrf_egu_5_TASK_TRIGGER_7},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[8] , nrf_egu_5_TASK_TRIGGER_8},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[9] , nrf_egu_5_TASK_TRIGGER_9},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[10] , nrf_egu_5_TASK_TRIGGER_10},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[11] , nrf_egu_5_TASK_TRIGGER_11},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[12] , nrf_egu_5_TASK_TRIGGER_12},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[13] , nrf_egu_5_TASK_TRIGGER_13},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[14] , nrf_egu_5_TASK_TRIGGER_14},
-    {(void*)&NRF_EGU_regs[5].TASKS_TRIGGER[15] , nrf_egu_5_TASK_TRIGGER_15},
+    NRF_EGU_FOR_EACH_TRIGGER(PPI_EGU_TASK)
 
     //End marker
     { NULL, NULL }
@@ -351,264 +250,228 @@ static const ppi_tasks_table_t ppi_tasks_table[]={ //just the ones we may use
 typedef struct {
   ppi_event_types_t event_type;
   void *event_addr;
+  const char *name; //Only for the routing dump
 } ppi_event_table_t;
 
+#define PPI_EVENT(type, reg) \
+    { .event_type = type, .event_addr = (void*)&(reg), .name = #type },
+#define PPI_TIMER_EVENT(t, cc) \
+    PPI_EVENT(TIMER##t##_EVENTS_COMPARE_##cc, NRF_TIMER_regs[t].EVENTS_COMPARE[cc])
+#define PPI_EGU_EVENT(inst, n) \
+    PPI_EVENT(EGU##inst##_EVENTS_TRIGGERED_##n, NRF_EGU_regs[inst].EVENTS_TRIGGERED[n])
+
 static const ppi_event_table_t ppi_events_table[] = { //better keep same order as in ppi_event_types_t
-    {CLOCK_EVENTS_HFCLKSTARTED, &NRF_CLOCK_regs.EVENTS_HFCLKSTARTED},
-    {CLOCK_EVENTS_LFCLKSTARTED, &NRF_CLOCK_regs.EVENTS_LFCLKSTARTED},
-    {CLOCK_EVENTS_DONE        , &NRF_CLOCK_regs.EVENTS_DONE        },
-    {CLOCK_EVENTS_CTTO        , &NRF_CLOCK_regs.EVENTS_CTTO        },
-    {CLOCK_EVENTS_CTSTARTED   , &NRF_CLOCK_regs.EVENTS_CTSTARTED   },
-    {CLOCK_EVENTS_CTSTOPPED   , &NRF_CLOCK_regs.EVENTS_CTSTOPPED   },
-
-    {RADIO_EVENTS_READY,   &NRF_RADIO_regs.EVENTS_READY},
-    {RADIO_EVENTS_ADDRESS, &NRF_RADIO_regs.EVENTS_ADDRESS},
-    {RADIO_EVENTS_PAYLOAD, &NRF_RADIO_regs.EVENTS_PAYLOAD},
-    {RADIO_EVENTS_END,     &NRF_RADIO_regs.EVENTS_END},
-    {RADIO_EVENTS_DISABLED,&NRF_RADIO_regs.EVENTS_DISABLED},
-    {RADIO_EVENTS_DEVMATCH,&NRF_RADIO_regs.EVENTS_DEVMATCH},
-    {RADIO_EVENTS_DEVMISS ,&NRF_RADIO_regs.EVENTS_DEVMISS},
-    {RADIO_EVENTS_RSSIEND, &NRF_RADIO_regs.EVENTS_RSSIEND},
-    {RADIO_EVENTS_BCMATCH, &NRF_RADIO_regs.EVENTS_BCMATCH},
-    {RADIO_EVENTS_CRCOK,   &NRF_RADIO_regs.EVENTS_CRCOK},
-    {RADIO_EVENTS_CRCERROR,&NRF_RADIO_regs.EVENTS_CRCERROR},
-    {RADIO_EVENTS_FRAMESTART,&NRF_RADIO_regs.EVENTS_FRAMESTART},
-    {RADIO_EVENTS_EDEND,   &NRF_RADIO_regs.EVENTS_EDEND},
-    {RADIO_EVENTS_EDSTOPPED, &NRF_RADIO_regs.EVENTS_EDSTOPPED},
-    {RADIO_EVENTS_CCAIDLE, &NRF_RADIO_regs.EVENTS_CCAIDLE},
-    {RADIO_EVENTS_CCABUSY, &NRF_RADIO_regs.EVENTS_CCABUSY},
-    {RADIO_EVENTS_CCASTOPPED, &NRF_RADIO_regs.EVENTS_CCASTOPPED},
-    {RADIO_EVENTS_RATEBOOST, &NRF_RADIO_regs.EVENTS_RATEBOOST},
-    {RADIO_EVENTS_TXREADY, &NRF_RADIO_regs.EVENTS_TXREADY},
-    {RADIO_EVENTS_RXREADY, &NRF_RADIO_regs.EVENTS_RXREADY},
-    {RADIO_EVENTS_MHRMATCH,&NRF_RADIO_regs.EVENTS_MHRMATCH},
-    {RADIO_EVENTS_SYNC,    &NRF_RADIO_regs.EVENTS_SYNC},
-    {RADIO_EVENTS_PHYEND,  &NRF_RADIO_regs.EVENTS_PHYEND},
-    {RADIO_EVENTS_CTEPRESENT,&NRF_RADIO_regs.EVENTS_CTEPRESENT},
-
-    {GPIOTE_EVENTS_IN_0, &NRF_GPIOTE_regs.EVENTS_IN[0]},
-    {GPIOTE_EVENTS_IN_1, &NRF_GPIOTE_regs.EVENTS_IN[1]},
-    {GPIOTE_EVENTS_IN_2, &NRF_GPIOTE_regs.EVENTS_IN[2]},
-    {GPIOTE_EVENTS_IN_3, &NRF_GPIOTE_regs.EVENTS_IN[3]},
-    {GPIOTE_EVENTS_IN_4, &NRF_GPIOTE_regs.EVENTS_IN[4]},
-    {GPIOTE_EVENTS_IN_5, &NRF_GPIOTE_regs.EVENTS_IN[5]},
-    {GPIOTE_EVENTS_IN_6, &NRF_GPIOTE_regs.EVENTS_IN[6]},
-    {GPIOTE_EVENTS_IN_7, &NRF_GPIOTE_regs.EVENTS_IN[7]},
-    {GPIOTE_EVENTS_PORT, &NRF_GPIOTE_regs.EVENTS_PORT},
-
-    {TIMER0_EVENTS_COMPARE_0, &NRF_TIMER_regs[0].EVENTS_COMPARE[0]},
-    {TIMER0_EVENTS_COMPARE_1, &NRF_TIMER_regs[0].EVENTS_COMPARE[1]},
-    {TIMER0_EVENTS_COMPARE_2, &NRF_TIMER_regs[0].EVENTS_COMPARE[2]},
-    {TIMER0_EVENTS_COMPARE_3, &NRF_TIMER_regs[0].EVENTS_COMPARE[3]},
-//    {TIMER0_EVENTS_COMPARE_4, &NRF_TIMER_regs[0].EVENTS_COMPARE[4]},
-//    {TIMER0_EVENTS_COMPARE_5, &NRF_TIMER_regs[0].EVENTS_COMPARE[5]},
-
-    {TIMER1_EVENTS_COMPARE_0, &NRF_TIMER_regs[1].EVENTS_COMPARE[0]},
-    {TIMER1_EVENTS_COMPARE_1, &NRF_TIMER_regs[1].EVENTS_COMPARE[1]},
-    {TIMER1_EVENTS_COMPARE_2, &NRF_TIMER_regs[1].EVENTS_COMPARE[2]},
-    {TIMER1_EVENTS_COMPARE_3, &NRF_TIMER_regs[1].EVENTS_COMPARE[3]},
-    //    {TIMER1_EVENTS_COMPARE_4, &NRF_TIMER_regs[1].EVENTS_COMPARE[4]},
-    //    {TIMER1_EVENTS_COMPARE_5, &NRF_TIMER_regs[1].EVENTS_COMPARE[5]},
-
-    {TIMER2_EVENTS_COMPARE_0, &NRF_TIMER_regs[2].EVENTS_COMPARE[0]},
-    {TIMER2_EVENTS_COMPARE_1, &NRF_TIMER_regs[2].EVENTS_COMPARE[1]},
-    {TIMER2_EVENTS_COMPARE_2, &NRF_TIMER_regs[2].EVENTS_COMPARE[2]},
-    {TIMER2_EVENTS_COMPARE_3, &NRF_TIMER_regs[2].EVENTS_COMPARE[3]},
-    //    {TIMER2_EVENTS_COMPARE_4, &NRF_TIMER_regs[2].EVENTS_COMPARE[4]},
-    //    {TIMER2_EVENTS_COMPARE_5, &NRF_TIMER_regs[2].EVENTS_COMPARE[5]},
-
-    {RTC0_EVENTS_OVRFLW, &NRF_RTC_regs[0].EVENTS_OVRFLW},
-    {RTC0_EVENTS_COMPARE_0, &NRF_RTC_regs[0].EVENTS_COMPARE[0]},
-    {RTC0_EVENTS_COMPARE_1, &NRF_RTC_regs[0].EVENTS_COMPARE[1]},
-    {RTC0_EVENTS_COMPARE_2, &NRF_RTC_regs[0].EVENTS_COMPARE[2]},
-    {RTC0_EVENTS_COMPARE_3, &NRF_RTC_regs[0].EVENTS_COMPARE[3]},
-
-    {TEMP_EVENTS_DATARDY, &NRF_TEMP_regs.EVENTS_DATARDY},
+    PPI_EVENT(CLOCK_EVENTS_HFCLKSTARTED, NRF_CLOCK_regs.EVENTS_HFCLKSTARTED)
+    PPI_EVENT(CLOCK_EVENTS_LFCLKSTARTED, NRF_CLOCK_regs.EVENTS_LFCLKSTARTED)
+    PPI_EVENT(CLOCK_EVENTS_DONE, NRF_CLOCK_regs.EVENTS_DONE)
+    PPI_EVENT(CLOCK_EVENTS_CTTO, NRF_CLOCK_regs.EVENTS_CTTO)
+    PPI_EVENT(CLOCK_EVENTS_CTSTARTED, NRF_CLOCK_regs.EVENTS_CTSTARTED)
+    PPI_EVENT(CLOCK_EVENTS_CTSTOPPED, NRF_CLOCK_regs.EVENTS_CTSTOPPED)
+
+    PPI_EVENT(RADIO_EVENTS_READY, NRF_RADIO_regs.EVENTS_READY)
+    PPI_EVENT(RADIO_EVENTS_ADDRESS, NRF_RADIO_regs.EVENTS_ADDRESS)
+    PPI_EVENT(RADIO_EVENTS_PAYLOAD, NRF_RADIO_regs.EVENTS_PAYLOAD)
+    PPI_EVENT(RADIO_EVENTS_END, NRF_RADIO_regs.EVENTS_END)
+    PPI_EVENT(RADIO_EVENTS_DISABLED, NRF_RADIO_regs.EVENTS_DISABLED)
+    PPI_EVENT(RADIO_EVENTS_DEVMATCH, NRF_RADIO_regs.EVENTS_DEVMATCH)
+    PPI_EVENT(RADIO_EVENTS_DEVMISS, NRF_RADIO_regs.EVENTS_DEVMISS)
+    PPI_EVENT(RADIO_EVENTS_RSSIEND, NRF_RADIO_regs.EVENTS_RSSIEND)
+    PPI_EVENT(RADIO_EVENTS_BCMATCH, NRF_RADIO_regs.EVENTS_BCMATCH)
+    PPI_EVENT(RADIO_EVENTS_CRCOK, NRF_RADIO_regs.EVENTS_CRCOK)
+    PPI_EVENT(RADIO_EVENTS_CRCERROR, NRF_RADIO_regs.EVENTS_CRCERROR)
+    PPI_EVENT(RADIO_EVENTS_FRAMESTART, NRF_RADIO_regs.EVENTS_FRAMESTART)
+    PPI_EVENT(RADIO_EVENTS_EDEND, NRF_RADIO_regs.EVENTS_EDEND)
+    PPI_EVENT(RADIO_EVENTS_EDSTOPPED, NRF_RADIO_regs.EVENTS_EDSTOPPED)
+    PPI_EVENT(RADIO_EVENTS_CCAIDLE, NRF_RADIO_regs.EVENTS_CCAIDLE)
+    PPI_EVENT(RADIO_EVENTS_CCABUSY, NRF_RADIO_regs.EVENTS_CCABUSY)
+    PPI_EVENT(RADIO_EVENTS_CCASTOPPED, NRF_RADIO_regs.EVENTS_CCASTOPPED)
+    PPI_EVENT(RADIO_EVENTS_RATEBOOST, NRF_RADIO_regs.EVENTS_RATEBOOST)
+    PPI_EVENT(RADIO_EVENTS_TXREADY, NRF_RADIO_regs.EVENTS_TXREADY)
+    PPI_EVENT(RADIO_EVENTS_RXREADY, NRF_RADIO_regs.EVENTS_RXREADY)
+    PPI_EVENT(RADIO_EVENTS_MHRMATCH, NRF_RADIO_regs.EVENTS_MHRMATCH)
+    PPI_EVENT(RADIO_EVENTS_SYNC, NRF_RADIO_regs.EVENTS_SYNC)
+    PPI_EVENT(RADIO_EVENTS_PHYEND, NRF_RADIO_regs.EVENTS_PHYEND)
+    PPI_EVENT(RADIO_EVENTS_CTEPRESENT, NRF_RADIO_regs.EVENTS_CTEPRESENT)
+
+    PPI_EVENT(GPIOTE_EVENTS_IN_0, NRF_GPIOTE_regs.EVENTS_IN[0])
+    PPI_EVENT(GPIOTE_EVENTS_IN_1, NRF_GPIOTE_regs.EVENTS_IN[1])
+    PPI_EVENT(GPIOTE_EVENTS_IN_2, NRF_GPIOTE_regs.EVENTS_IN[2])
+    PPI_EVENT(GPIOTE_EVENTS_IN_3, NRF_GPIOTE_regs.EVENTS_IN[3])
+    PPI_EVENT(GPIOTE_EVENTS_IN_4, NRF_GPIOTE_regs.EVENTS_IN[4])
+    PPI_EVENT(GPIOTE_EVENTS_IN_5, NRF_GPIOTE_regs.EVENTS_IN[5])
+    PPI_EVENT(GPIOTE_EVENTS_IN_6, NRF_GPIOTE_regs.EVENTS_IN[6])
+    PPI_EVENT(GPIOTE_EVENTS_IN_7, NRF_GPIOTE_regs.EVENTS_IN[7])
+    PPI_EVENT(GPIOTE_EVENTS_PORT, NRF_GPIOTE_regs.EVENTS_PORT)
+
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_EVENT, 0)
+
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_EVENT, 1)
+
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_EVENT, 2)
+
+    PPI_EVENT(RTC0_EVENTS_OVRFLW, NRF_RTC_regs[0].EVENTS_OVRFLW)
+    PPI_EVENT(RTC0_EVENTS_COMPARE_0, NRF_RTC_regs[0].EVENTS_COMPARE[0])
+    PPI_EVENT(RTC0_EVENTS_COMPARE_1, NRF_RTC_regs[0].EVENTS_COMPARE[1])
+    PPI_EVENT(RTC0_EVENTS_COMPARE_2, NRF_RTC_regs[0].EVENTS_COMPARE[2])
+    PPI_EVENT(RTC0_EVENTS_COMPARE_3, NRF_RTC_regs[0].EVENTS_COMPARE[3])
+
+    PPI_EVENT(TEMP_EVENTS_DATARDY, NRF_TEMP_regs.EVENTS_DATARDY)
 
     //{RNG_EVENTS_VALRDY, &NRF_RNG_regs.EVENTS_VALRDY},
 
-    {CCM_EVENTS_ENDKSGEN, &NRF_CCM_regs.EVENTS_ENDKSGEN},
-    {CCM_EVENTS_ENDCRYPT, &NRF_CCM_regs.EVENTS_ENDCRYPT},
-    {CCM_EVENTS_ERROR,    &NRF_CCM_regs.EVENTS_ERROR},
-
-    {RTC1_EVENTS_OVRFLW, &NRF_RTC_regs[1].EVENTS_OVRFLW},
-    {RTC1_EVENTS_COMPARE_0, &NRF_RTC_regs[1].EVENTS_COMPARE[0]},
-    {RTC1_EVENTS_COMPARE_1, &NRF_RTC_regs[1].EVENTS_COMPARE[1]},
-    {RTC1_EVENTS_COMPARE_2, &NRF_RTC_regs[1].EVENTS_COMPARE[2]},
-    {RTC1_EVENTS_COMPARE_3, &NRF_RTC_regs[1].EVENTS_COMPARE[3]},
-
-    {EGU0_EVENTS_TRIGGERED_0, &NRF_EGU_regs[0].EVENTS_TRIGGERED[0]}, /*These are autogenerated (See NRF_EGU.c)*/
-    {EGU0_EVENTS_TRIGGERED_1, &NRF_EGU_regs[0].EVENTS_TRIGGERED[1]},
-    {EGU0_EVENTS_TRIGGERED_2, &NRF_EGU_regs[0].EVENTS_TRIGGERED[2]},
-    {EGU0_EVENTS_TRIGGERED_3, &NRF_EGU_regs[0].EVENTS_TRIGGERED[3]},
-    {EGU0_EVENTS_TRIGGERED_4, &NRF_EGU_regs[0].EVENTS_TRIGGERED[4]},
-    {EGU0_EVENTS_TRIGGERED_5, &NRF_EGU_regs[0].EVENTS_TRIGGERED[5]},
-    {EGU0_EVENTS_TRIGGERED_6, &NRF_EGU_regs[0].EVENTS_TRIGGERED[6]},
-    {EGU0_EVENTS_TRIGGERED_7, &NRF_EGU_regs[0].EVENTS_TRIGGERED[7]},
-    {EGU0_EVENTS_TRIGGERED_8, &NRF_EGU_regs[0].EVENTS_TRIGGERED[8]},
-    {EGU0_EVENTS_TRIGGERED_9, &NRF_EGU_regs[0].EVENTS_TRIGGERED[9]},
-    {EGU0_EVENTS_TRIGGERED_10, &NRF_EGU_regs[0].EVENTS_TRIGGERED[10]},
-    {EGU0_EVENTS_TRIGGERED_11, &NRF_EGU_regs[0].EVENTS_TRIGGERED[11]},
-    {EGU0_EVENTS_TRIGGERED_12, &NRF_EGU_regs[0].EVENTS_TRIGGERED[12]},
-    {EGU0_EVENTS_TRIGGERED_13, &NRF_EGU_regs[0].EVENTS_TRIGGERED[13]},
-    {EGU0_EVENTS_TRIGGERED_14, &NRF_EGU_regs[0].EVENTS_TRIGGERED[14]},
-    {EGU0_EVENTS_TRIGGERED_15, &NRF_EGU_regs[0].EVENTS_TRIGGERED[15]},
-    {EGU1_EVENTS_TRIGGERED_0, &NRF_EGU_regs[1].EVENTS_TRIGGERED[0]},
-    {EGU1_EVENTS_TRIGGERED_1, &NRF_EGU_regs[1].EVENTS_TRIGGERED[1]},
-    {EGU1_EVENTS_TRIGGERED_2, &NRF_EGU_regs[1].EVENTS_TRIGGERED[2]},
-    {EGU1_EVENTS_TRIGGERED_3, &NRF_EGU_regs[1].EVENTS_TRIGGERED[3]},
-    {EGU1_EVENTS_TRIGGERED_4, &NRF_EGU_regs[1].EVENTS_TRIGGERED[4]},
-    {EGU1_EVENTS_TRIGGERED_5, &NRF_EGU_regs[1].EVENTS_TRIGGERED[5]},
-    {EGU1_EVENTS_TRIGGERED_6, &NRF_EGU_regs[1].EVENTS_TRIGGERED[6]},
-    {EGU1_EVENTS_TRIGGERED_7, &NRF_EGU_regs[1].EVENTS_TRIGGERED[7]},
-    {EGU1_EVENTS_TRIGGERED_8, &NRF_EGU_regs[1].EVENTS_TRIGGERED[8]},
-    {EGU1_EVENTS_TRIGGERED_9, &NRF_EGU_regs[1].EVENTS_TRIGGERED[9]},
-    {EGU1_EVENTS_TRIGGERED_10, &NRF_EGU_regs[1].EVENTS_TRIGGERED[10]},
-    {EGU1_EVENTS_TRIGGERED_11, &NRF_EGU_regs[1].EVENTS_TRIGGERED[11]},
-    {EGU1_EVENTS_TRIGGERED_12, &NRF_EGU_regs[1].EVENTS_TRIGGERED[12]},
-    {EGU1_EVENTS_TRIGGERED_13, &NRF_EGU_regs[1].EVENTS_TRIGGERED[13]},
-    {EGU1_EVENTS_TRIGGERED_14, &NRF_EGU_regs[1].EVENTS_TRIGGERED[14]},
-    {EGU1_EVENTS_TRIGGERED_15, &NRF_EGU_regs[1].EVENTS_TRIGGERED[15]},
-    {EGU2_EVENTS_TRIGGERED_0, &NRF_EGU_regs[2].EVENTS_TRIGGERED[0]},
-    {EGU2_EVENTS_TRIGGERED_1, &NRF_EGU_regs[2].EVENTS_TRIGGERED[1]},
-    {EGU2_EVENTS_TRIGGERED_2, &NRF_EGU_regs[2].EVENTS_TRIGGERED[2]},
-    {EGU2_EVENTS_TRIGGERED_3, &NRF_EGU_regs[2].EVENTS_TRIGGERED[3]},
-    {EGU2_EVENTS_TRIGGERED_4, &NRF_EGU_regs[2].EVENTS_TRIGGERED[4]},
-    {EGU2_EVENTS_TRIGGERED_5, &NRF_EGU_regs[2].EVENTS_TRIGGERED[5]},
-    {EGU2_EVENTS_TRIGGERED_6, &NRF_EGU_regs[2].EVENTS_TRIGGERED[6]},
-    {EGU2_EVENTS_TRIGGERED_7, &NRF_EGU_regs[2].EVENTS_TRIGGERED[7]},
-    {EGU2_EVENTS_TRIGGERED_8, &NRF_EGU_regs[2].EVENTS_TRIGGERED[8]},
-    {EGU2_EVENTS_TRIGGERED_9, &NRF_EGU_regs[2].EVENTS_TRIGGERED[9]},
-    {EGU2_EVENTS_TRIGGERED_10, &NRF_EGU_regs[2].EVENTS_TRIGGERED[10]},
-    {EGU2_EVENTS_TRIGGERED_11, &NRF_EGU_regs[2].EVENTS_TRIGGERED[11]},
-    {EGU2_EVENTS_TRIGGERED_12, &NRF_EGU_regs[2].EVENTS_TRIGGERED[12]},
-    {EGU2_EVENTS_TRIGGERED_13, &NRF_EGU_regs[2].EVENTS_TRIGGERED[13]},
-    {EGU2_EVENTS_TRIGGERED_14, &NRF_EGU_regs[2].EVENTS_TRIGGERED[14]},
-    {EGU2_EVENTS_TRIGGERED_15, &NRF_EGU_regs[2].EVENTS_TRIGGERED[15]},
-    {EGU3_EVENTS_TRIGGERED_0, &NRF_EGU_regs[3].EVENTS_TRIGGERED[0]},
-    {EGU3_EVENTS_TRIGGERED_1, &NRF_EGU_regs[3].EVENTS_TRIGGERED[1]},
-    {EGU3_EVENTS_TRIGGERED_2, &NRF_EGU_regs[3].EVENTS_TRIGGERED[2]},
-    {EGU3_EVENTS_TRIGGERED_3, &NRF_EGU_regs[3].EVENTS_TRIGGERED[3]},
-    {EGU3_EVENTS_TRIGGERED_4, &NRF_EGU_regs[3].EVENTS_TRIGGERED[4]},
-    {EGU3_EVENTS_TRIGGERED_5, &NRF_EGU_regs[3].EVENTS_TRIGGERED[5]},
-    {EGU3_EVENTS_TRIGGERED_6, &NRF_EGU_regs[3].EVENTS_TRIGGERED[6]},
-    {EGU3_EVENTS_TRIGGERED_7, &NRF_EGU_regs[3].EVENTS_TRIGGERED[7]},
-    {EGU3_EVENTS_TRIGGERED_8, &NRF_EGU_regs[3].EVENTS_TRIGGERED[8]},
-    {EGU3_EVENTS_TRIGGERED_9, &NRF_EGU_regs[3].EVENTS_TRIGGERED[9]},
-    {EGU3_EVENTS_TRIGGERED_10, &NRF_EGU_regs[3].EVENTS_TRIGGERED[10]},
-    {EGU3_EVENTS_TRIGGERED_11, &NRF_EGU_regs[3].EVENTS_TRIGGERED[11]},
-    {EGU3_EVENTS_TRIGGERED_12, &NRF_EGU_regs[3].EVENTS_TRIGGERED[12]},
-    {EGU3_EVENTS_TRIGGERED_13, &NRF_EGU_regs[3].EVENTS_TRIGGERED[13]},
-    {EGU3_EVENTS_TRIGGERED_14, &NRF_EGU_regs[3].EVENTS_TRIGGERED[14]},
-    {EGU3_EVENTS_TRIGGERED_15, &NRF_EGU_regs[3].EVENTS_TRIGGERED[15]},
-    {EGU4_EVENTS_TRIGGERED_0, &NRF_EGU_regs[4].EVENTS_TRIGGERED[0]},
-    {EGU4_EVENTS_TRIGGERED_1, &NRF_EGU_regs[4].EVENTS_TRIGGERED[1]},
-    {EGU4_EVENTS_TRIGGERED_2, &NRF_EGU_regs[4].EVENTS_TRIGGERED[2]},
-    {EGU4_EVENTS_TRIGGERED_3, &NRF_EGU_regs[4].EVENTS_TRIGGERED[3]},
-    {EGU4_EVENTS_TRIGGERED_4, &NRF_EGU_regs[4].EVENTS_TRIGGERED[4]},
-    {EGU4_EVENTS_TRIGGERED_5, &NRF_EGU_regs[4].EVENTS_TRIGGERED[5]},
-    {EGU4_EVENTS_TRIGGERED_6, &NRF_EGU_regs[4].EVENTS_TRIGGERED[6]},
-    {EGU4_EVENTS_TRIGGERED_7, &NRF_EGU_regs[4].EVENTS_TRIGGERED[7]},
-    {EGU4_EVENTS_TRIGGERED_8, &NRF_EGU_regs[4].EVENTS_TRIGGERED[8]},
-    {EGU4_EVENTS_TRIGGERED_9, &NRF_EGU_regs[4].EVENTS_TRIGGERED[9]},
-    {EGU4_EVENTS_TRIGGERED_10, &NRF_EGU_regs[4].EVENTS_TRIGGERED[10]},
-    {EGU4_EVENTS_TRIGGERED_11, &NRF_EGU_regs[4].EVENTS_TRIGGERED[11]},
-    {EGU4_EVENTS_TRIGGERED_12, &NRF_EGU_regs[4].EVENTS_TRIGGERED[12]},
-    {EGU4_EVENTS_TRIGGERED_13, &NRF_EGU_regs[4].EVENTS_TRIGGERED[13]},
-    {EGU4_EVENTS_TRIGGERED_14, &NRF_EGU_regs[4].EVENTS_TRIGGERED[14]},
-    {EGU4_EVENTS_TRIGGERED_15, &NRF_EGU_regs[4].EVENTS_TRIGGERED[15]},
-    {EGU5_EVENTS_TRIGGERED_0, &NRF_EGU_regs[5].EVENTS_TRIGGERED[0]},
-    {EGU5_EVENTS_TRIGGERED_1, &NRF_EGU_regs[5].EVENTS_TRIGGERED[1]},
-    {EGU5_EVENTS_TRIGGERED_2, &NRF_EGU_regs[5].EVENTS_TRIGGERED[2]},
-    {EGU5_EVENTS_TRIGGERED_3, &NRF_EGU_regs[5].EVENTS_TRIGGERED[3]},
-    {EGU5_EVENTS_TRIGGERED_4, &NRF_EGU_regs[5].EVENTS_TRIGGERED[4]},
-    {EGU5_EVENTS_TRIGGERED_5, &NRF_EGU_regs[5].EVENTS_TRIGGERED[5]},
-    {EGU5_EVENTS_TRIGGERED_6, &NRF_EGU_regs[5].EVENTS_TRIGGERED[6]},
-    {EGU5_EVENTS_TRIGGERED_7, &NRF_EGU_regs[5].EVENTS_TRIGGERED[7]},
-    {EGU5_EVENTS_TRIGGERED_8, &NRF_EGU_regs[5].EVENTS_TRIGGERED[8]},
-    {EGU5_EVENTS_TRIGGERED_9, &NRF_EGU_regs[5].EVENTS_TRIGGERED[9]},
-    {EGU5_EVENTS_TRIGGERED_10, &NRF_EGU_regs[5].EVENTS_TRIGGERED[10]},
-    {EGU5_EVENTS_TRIGGERED_11, &NRF_EGU_regs[5].EVENTS_TRIGGERED[11]},
-    {EGU5_EVENTS_TRIGGERED_12, &NRF_EGU_regs[5].EVENTS_TRIGGERED[12]},
-    {EGU5_EVENTS_TRIGGERED_13, &NRF_EGU_regs[5].EVENTS_TRIGGERED[13]},
-    {EGU5_EVENTS_TRIGGERED_14, &NRF_EGU_regs[5].EVENTS_TRIGGERED[14]},
-    {EGU5_EVENTS_TRIGGERED_15, &NRF_EGU_regs[5].EVENTS_TRIGGERED[15]},
-
-    {TIMER3_EVENTS_COMPARE_0, &NRF_TIMER_regs[3].EVENTS_COMPARE[0]},
-    {TIMER3_EVENTS_COMPARE_1, &NRF_TIMER_regs[3].EVENTS_COMPARE[1]},
-    {TIMER3_EVENTS_COMPARE_2, &NRF_TIMER_regs[3].EVENTS_COMPARE[2]},
-    {TIMER3_EVENTS_COMPARE_3, &NRF_TIMER_regs[3].EVENTS_COMPARE[3]},
-    {TIMER3_EVENTS_COMPARE_4, &NRF_TIMER_regs[3].EVENTS_COMPARE[4]},
-    {TIMER3_EVENTS_COMPARE_5, &NRF_TIMER_regs[3].EVENTS_COMPARE[5]},
-
-    {TIMER4_EVENTS_COMPARE_0, &NRF_TIMER_regs[4].EVENTS_COMPARE[0]},
-    {TIMER4_EVENTS_COMPARE_1, &NRF_TIMER_regs[4].EVENTS_COMPARE[1]},
-    {TIMER4_EVENTS_COMPARE_2, &NRF_TIMER_regs[4].EVENTS_COMPARE[2]},
-    {TIMER4_EVENTS_COMPARE_3, &NRF_TIMER_regs[4].EVENTS_COMPARE[3]},
-    {TIMER4_EVENTS_COMPARE_4, &NRF_TIMER_regs[4].EVENTS_COMPARE[4]},
-    {TIMER4_EVENTS_COMPARE_5, &NRF_TIMER_regs[4].EVENTS_COMPARE[5]},
-
-    {RTC2_EVENTS_OVRFLW, &NRF_RTC_regs[2].EVENTS_OVRFLW},
-    {RTC2_EVENTS_COMPARE_0, &NRF_RTC_regs[2].EVENTS_COMPARE[0]},
-    {RTC2_EVENTS_COMPARE_1, &NRF_RTC_regs[2].EVENTS_COMPARE[1]},
-    {RTC2_EVENTS_COMPARE_2, &NRF_RTC_regs[2].EVENTS_COMPARE[2]},
-    {RTC2_EVENTS_COMPARE_3, &NRF_RTC_regs[2].EVENTS_COMPARE[3]},
+    PPI_EVENT(CCM_EVENTS_ENDKSGEN, NRF_CCM_regs.EVENTS_ENDKSGEN)
+    PPI_EVENT(CCM_EVENTS_ENDCRYPT, NRF_CCM_regs.EVENTS_ENDCRYPT)
+    PPI_EVENT(CCM_EVENTS_ERROR, NRF_CCM_regs.EVENTS_ERROR)
+
+    PPI_EVENT(RTC1_EVENTS_OVRFLW, NRF_RTC_regs[1].EVENTS_OVRFLW)
+    PPI_EVENT(RTC1_EVENTS_COMPARE_0, NRF_RTC_regs[1].EVENTS_COMPARE[0])
+    PPI_EVENT(RTC1_EVENTS_COMPARE_1, NRF_RTC_regs[1].EVENTS_COMPARE[1])
+    PPI_EVENT(RTC1_EVENTS_COMPARE_2, NRF_RTC_regs[1].EVENTS_COMPARE[2])
+    PPI_EVENT(RTC1_EVENTS_COMPARE_3, NRF_RTC_regs[1].EVENTS_COMPARE[3])
+
+    NRF_EGU_FOR_EACH_TRIGGER(PPI_EGU_EVENT)
+
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_EVENT, 3)
+
+    NRF_TIMER_FOR_EACH_CC(PPI_TIMER_EVENT, 4)
+
+    PPI_EVENT(RTC2_EVENTS_OVRFLW, NRF_RTC_regs[2].EVENTS_OVRFLW)
+    PPI_EVENT(RTC2_EVENTS_COMPARE_0, NRF_RTC_regs[2].EVENTS_COMPARE[0])
+    PPI_EVENT(RTC2_EVENTS_COMPARE_1, NRF_RTC_regs[2].EVENTS_COMPARE[1])
+    PPI_EVENT(RTC2_EVENTS_COMPARE_2, NRF_RTC_regs[2].EVENTS_COMPARE[2])
+    PPI_EVENT(RTC2_EVENTS_COMPARE_3, NRF_RTC_regs[2].EVENTS_COMPARE[3])
 
     {NUMBER_PPI_EVENTS, NULL} //End marker
 };
 
+#define PPI_N_TASKS  (sizeof(ppi_tasks_table)/sizeof(ppi_tasks_table[0]) - 1)
+#define PPI_N_EVENTS (sizeof(ppi_events_table)/sizeof(ppi_events_table[0]) - 1)
 
-static void set_fixed_channel_routes(){
-  //TODO: add handler function pointers as we add those functions while modelling the different parts
+/*
+ * Hash tables (open addressing, linear probing) from a task/event register
+ * address to its index in ppi_tasks_table/ppi_events_table (+1, 0 = empty),
+ * so the TEP & EEP writes do not need to search the whole tables.
+ * Built once, in nrf_ppi_init().
+ * The addresses are the same for all devices (see NRF_HW_ctx.h),
+ * so these are shared by all of them.
+ */
+#define PPI_ADDR_HASH_BITS 9
+#define PPI_ADDR_HASH_SIZE (1 << PPI_ADDR_HASH_BITS)
+static uint16_t ppi_tasks_hash[PPI_ADDR_HASH_SIZE];
+static uint16_t ppi_events_hash[PPI_ADDR_HASH_SIZE];
+static bool ppi_hashes_built;
+
+static inline unsigned int ppi_addr_hash(void *addr){
+  /* Registers are 32bit aligned, so the 2 lsbits carry no information */
+  return ((uint32_t)((uintptr_t)addr >> 2) * 2654435761U) >> (32 - PPI_ADDR_HASH_BITS);
+}
+
+static void ppi_addr_hash_add(uint16_t *hash, void *addr, unsigned int index){
+  unsigned int i = ppi_addr_hash(addr);
+  while ( hash[i] != 0 ){
+    i = ( i + 1 ) & ( PPI_ADDR_HASH_SIZE - 1 );
+  }
+  hash[i] = index + 1;
+}
 
+static void ppi_build_hashes(void){
+  if ( ppi_hashes_built ){
+    return;
+  }
+  /* Keep the load factor low so the probe sequences stay short */
+  if ( ( PPI_N_TASKS > PPI_ADDR_HASH_SIZE/2 ) || ( PPI_N_EVENTS > PPI_ADDR_HASH_SIZE/2 ) ){
+    bs_trace_error_line("PPI: PPI_ADDR_HASH_BITS too small for the tasks/events tables\n");
+  }
+  for ( unsigned int i = 0 ; i < PPI_N_TASKS; i++ ){
+    ppi_addr_hash_add(ppi_tasks_hash, ppi_tasks_table[i].task_addr, i);
+  }
+  for ( unsigned int i = 0 ; i < PPI_N_EVENTS; i++ ){
+    ppi_addr_hash_add(ppi_events_hash, ppi_events_table[i].event_addr, i);
+  }
+  ppi_hashes_built = true;
+}
+
+/*
+ * Find the task whose register is at <addr>
+ * Returns its id, or PPI_NO_TASK if there is none
+ */
+static ppi_task_id_t ppi_task_id_by_addr(void *addr){
+  unsigned int i = ppi_addr_hash(addr);
+  while ( ppi_tasks_hash[i] != 0 ){
+    if ( ppi_tasks_table[ppi_tasks_hash[i] - 1].task_addr == addr ){
+      return ppi_tasks_hash[i];
+    }
+    i = ( i + 1 ) & ( PPI_ADDR_HASH_SIZE - 1 );
+  }
+  return PPI_NO_TASK;
+}
+
+/*
+ * Find the event whose register is at <addr>
+ * Returns NULL if there is none
+ */
+static const ppi_event_table_t *ppi_event_by_addr(void *addr){
+  unsigned int i = ppi_addr_hash(addr);
+  while ( ppi_events_hash[i] != 0 ){
+    const ppi_event_table_t *event = &ppi_events_table[ppi_events_hash[i] - 1];
+    if ( event->event_addr == addr ){
+      return event;
+    }
+    i = ( i + 1 ) & ( PPI_ADDR_HASH_SIZE - 1 );
+  }
+  return NULL;
+}
+
+
+static void set_fixed_channel_routes(){
   //Set the fixed channels configuration:
   //  20 TIMER0->EVENTS_COMPARE[0] RADIO->TASKS_TXEN
     ppi_evt_to_ch[TIMER0_EVENTS_COMPARE_0].channels_mask |= ( 1 << 20 );
-    ppi_ch_tasks[20].tep_f = nrf_radio_tasks_TXEN; //RADIO->TASKS_TXEN
+    ppi_ch_tasks[20].tep = ppi_task_id_by_addr((void*)&NRF_RADIO_regs.TASKS_TXEN);
 
   //  21 TIMER0->EVENTS_COMPARE[0] RADIO->TASKS_RXEN
     ppi_evt_to_ch[TIMER0_EVENTS_COMPARE_0].channels_mask |= ( 1 << 21 );
-    ppi_ch_tasks[21].tep_f = nrf_radio_tasks_RXEN; //RADIO->TASKS_RXEN
+    ppi_ch_tasks[21].tep = ppi_task_id_by_addr((void*)&NRF_RADIO_regs.TASKS_RXEN);
 
   //  22 TIMER0->EVENTS_COMPARE[1] RADIO->TASKS_DISABLE
     ppi_evt_to_ch[TIMER0_EVENTS_COMPARE_1].channels_mask |= ( 1 << 22 );
-    ppi_ch_tasks[22].tep_f = nrf_radio_tasks_DISABLE; //RADIO->TASKS_DISABLE
+    ppi_ch_tasks[22].tep = ppi_task_id_by_addr((void*)&NRF_RADIO_regs.TASKS_DISABLE);
 
   //  23 RADIO->EVENTS_BCMATCH AAR->TASKS_START
     ppi_evt_to_ch[RADIO_EVENTS_BCMATCH].channels_mask |= ( 1 << 23 );
-    ppi_ch_tasks[23].tep_f = nrf_aar_TASK_START; //AAR->TASKS_START
+    ppi_ch_tasks[23].tep = ppi_task_id_by_addr((void*)&NRF_AAR_regs.TASKS_START);
 
   //  24 RADIO->EVENTS_READY CCM->TASKS_KSGEN
     ppi_evt_to_ch[RADIO_EVENTS_READY].channels_mask |= ( 1 << 24 );
-    ppi_ch_tasks[24].tep_f = nrf_ccm_TASK_KSGEN; //CCM->TASKS_KSGEN
+    ppi_ch_tasks[24].tep = ppi_task_id_by_addr((void*)&NRF_CCM_regs.TASKS_KSGEN);
 
   //  25 RADIO->EVENTS_ADDRESS CCM->TASKS_CRYPT
     ppi_evt_to_ch[RADIO_EVENTS_ADDRESS].channels_mask |= ( 1 << 25 );
-    ppi_ch_tasks[25].tep_f = nrf_ccm_TASK_CRYPT; //CCM->TASKS_CRYPT
+    ppi_ch_tasks[25].tep = ppi_task_id_by_addr((void*)&NRF_CCM_regs.TASKS_CRYPT);
 
   //  26 RADIO->EVENTS_ADDRESS TIMER0->TASKS_CAPTURE[1]
     ppi_evt_to_ch[RADIO_EVENTS_ADDRESS].channels_mask |= ( 1 << 26 );
-    ppi_ch_tasks[26].tep_f = nrf_timer0_TASK_CAPTURE_1; //TIMER0->TASKS_CAPTURE[1]
+    ppi_ch_tasks[26].tep = ppi_task_id_by_addr((void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[1]);
 
   //  27 RADIO->EVENTS_END TIMER0->TASKS_CAPTURE[2]
     ppi_evt_to_ch[RADIO_EVENTS_END].channels_mask |= ( 1 << 27 );
-    ppi_ch_tasks[27].tep_f = nrf_timer0_TASK_CAPTURE_2; //TIMER0->TASKS_CAPTURE[2]
+    ppi_ch_tasks[27].tep = ppi_task_id_by_addr((void*)&NRF_TIMER_regs[0].TASKS_CAPTURE[2]);
 
   //  28 RTC0->EVENTS_COMPARE[0] RADIO->TASKS_TXEN
     ppi_evt_to_ch[RTC0_EVENTS_COMPARE_0].channels_mask |= ( 1 << 28 );
-    ppi_ch_tasks[28].tep_f = nrf_radio_tasks_TXEN; //RADIO->TASKS_TXEN
+    ppi_ch_tasks[28].tep = ppi_task_id_by_addr((void*)&NRF_RADIO_regs.TASKS_TXEN);
 
   //  29 RTC0->EVENTS_COMPARE[0] RADIO->TASKS_RXEN
     ppi_evt_to_ch[RTC0_EVENTS_COMPARE_0].channels_mask |= ( 1 << 29 );
-    ppi_ch_tasks[29].tep_f = nrf_radio_tasks_RXEN; //RADIO->TASKS_RXEN
+    ppi_ch_tasks[29].tep = ppi_task_id_by_addr((void*)&NRF_RADIO_regs.TASKS_RXEN);
 
   //  30 RTC0->EVENTS_COMPARE[0] TIMER0->TASKS_CLEAR
     ppi_evt_to_ch[RTC0_EVENTS_COMPARE_0].channels_mask |= ( 1 << 30 );
-    ppi_ch_tasks[30].tep_f = nrf_timer0_TASK_CLEAR; //TIMER0->TASKS_CLEAR
+    ppi_ch_tasks[30].tep = ppi_task_id_by_addr((void*)&NRF_TIMER_regs[0].TASKS_CLEAR);
 
   //  31 RTC0->EVENTS_COMPARE[0] TIMER0->TASKS_START
     ppi_evt_to_ch[RTC0_EVENTS_COMPARE_0].channels_mask |= ( (uint32_t)1 << 31 );
-    ppi_ch_tasks[31].tep_f = nrf_timer0_TASK_START; //TIMER0->TASKS_START
+    ppi_ch_tasks[31].tep = ppi_task_id_by_addr((void*)&NRF_TIMER_regs[0].TASKS_START);
 }
 
 /*
@@ -616,13 +479,58 @@ static void set_fixed_channel_routes(){
  * and then trigger them.
  * We do this to filter out duplicate tasks caused by the same event,
  * as this is a use case
+ *
+ * A task is not queued again while it is pending (its bit is set in <pending>),
+ * so the queue can never hold more than PPI_N_TASKS entries.
+ * Events raised by the tasks while the queue is being executed (draining)
+ * just add their tasks to it.
+ * While coalescing (see nrf_ppi_coalesce_begin()) the tasks already triggered
+ * in this window are also marked in <triggered>, and not queued again.
  */
-volatile static struct {
-  dest_f_t* q;
+static NRF_HW_STATE_LOCAL struct {
+  ppi_task_id_t q[PPI_N_TASKS]; //Circular buffer
+  uint first;
   uint used;
-  uint size;
+  uint64_t pending[(PPI_N_TASKS + 1 + 63)/64]; //Indexed by task id
+  uint64_t triggered[(PPI_N_TASKS + 1 + 63)/64]; //Indexed by task id
+  bool any_triggered; //Any bit set in <triggered>
+  bool draining;
+  bool coalescing;
 } tasks_queue;
-#define TASK_QUEUE_ALLOC_SIZE 64
+
+/*
+ * Precompiled list of tasks each event triggers, out of the channels routing
+ * and which channels are enabled, without duplicates and in the order in which
+ * they are to be triggered.
+ * The tasks of event <e> are task[first[e]] .. task[first[e+1] - 1].
+ * As each channel is fed by at most one event, all lists together cannot hold
+ * more than 2 tasks per channel.
+ *
+ * They are rebuilt on the next event after the routing (EEP, TEP or FORK_TEP)
+ * changes (valid = false), or after CHEN changes. As the SW can write CHEN
+ * directly, this is detected by comparing it to the value they were built for.
+ */
+static NRF_HW_STATE_LOCAL struct {
+  uint8_t first[NUMBER_PPI_EVENTS + 1];
+  ppi_task_id_t task[2*NUMBER_PPI_CHANNELS];
+  uint32_t chen;
+  bool valid;
+} ppi_evt_tasks;
+
+/*
+ * Optional activity counters (-hw_ppi_stats), dumped together with the
+ * routing by nrf_ppi_dump()
+ * Allocated only when enabled (NULL otherwise), so they do not add to the
+ * per device state copied in each context switch
+ */
+static NRF_HW_STATE_LOCAL struct {
+  uint64_t evt_count[NUMBER_PPI_EVENTS]; //Times each event was raised
+  bs_time_t evt_last[NUMBER_PPI_EVENTS]; //Last time (HW time) it was raised
+  uint64_t ch_count[NUMBER_PPI_CHANNELS]; //Times each channel fired (its event came while enabled)
+  bs_time_t ch_last[NUMBER_PPI_CHANNELS];
+  uint64_t task_count[PPI_N_TASKS + 1]; //Times each task was triggered, indexed by task id
+  uint64_t tasks_coalesced; //Task triggers dropped as that task was already pending or triggered
+} *ppi_stats;
 
 
 /**
@@ -632,46 +540,198 @@ void nrf_ppi_init(void) {
   memset(&NRF_PPI_regs, 0, sizeof(NRF_PPI_regs));
   memset(ppi_ch_tasks, 0, sizeof(ppi_ch_tasks));
   memset(ppi_evt_to_ch, 0, sizeof(ppi_evt_to_ch));
+  ppi_build_hashes();
   set_fixed_channel_routes();
-  tasks_queue.q = (dest_f_t*)bs_calloc(TASK_QUEUE_ALLOC_SIZE, sizeof(dest_f_t));
-  tasks_queue.size = TASK_QUEUE_ALLOC_SIZE;
+  for (int ch_nbr = 0 ; ch_nbr < NUMBER_PPI_CHANNELS ; ch_nbr++){
+    ppi_ch_to_evt[ch_nbr] = NUMBER_PPI_EVENTS;
+  }
+  for (int i = 0 ; i < NUMBER_PPI_EVENTS ; i++){
+    for (int ch_nbr = 0 ; ch_nbr < NUMBER_PPI_CHANNELS ; ch_nbr++){
+      if ( ppi_evt_to_ch[i].channels_mask & ( (uint32_t)1 << ch_nbr ) ){
+        ppi_ch_to_evt[ch_nbr] = i;
+      }
+    }
+  }
+  memset(&tasks_queue, 0, sizeof(tasks_queue));
+  ppi_evt_tasks.valid = false;
 }
 
 /**
  * Cleanup the PPI model before exiting the program
  */
 void nrf_ppi_clean_up(void) {
-  if (tasks_queue.q) {
-    free(tasks_queue.q);
-    tasks_queue.q = NULL;
+  if ( ppi_stats != NULL ){
+    nrf_ppi_dump();
+    free(ppi_stats);
+    ppi_stats = NULL;
   }
 }
 
-static void nrf_ppi_enqueue_task(dest_f_t task) {
-  int i;
-  for (i = 0; i < tasks_queue.used; i++){
-    if (tasks_queue.q[i] == task){ //We ignore dups
-      return;
+/**
+ * Enable (or disable) the PPI activity counters, and reset them
+ */
+void nrf_ppi_stats_enable(bool enable){
+  free(ppi_stats);
+  ppi_stats = enable ? bs_calloc(1, sizeof(*ppi_stats)) : NULL;
+}
+
+static const char *ppi_task_name(ppi_task_id_t task){
+  return task == PPI_NO_TASK ? "-" : ppi_tasks_table[task - 1].name;
+}
+
+static void ppi_dump_channel(int ch_nbr){
+  bool enabled = NRF_PPI_regs.CHEN & ( (uint32_t)1 << ch_nbr );
+
+  if ( ppi_stats != NULL ){
+    bs_trace_raw_time(1, "PPI:   ch %2i (%s), fired %"PRIu64" times, last at %"PRItime" us"
+                      " -> %s, fork -> %s\n",
+                      ch_nbr, enabled ? "enabled" : "disabled",
+                      ppi_stats->ch_count[ch_nbr], ppi_stats->ch_last[ch_nbr],
+                      ppi_task_name(ppi_ch_tasks[ch_nbr].tep),
+                      ppi_task_name(ppi_ch_tasks[ch_nbr].fork_tep));
+  } else {
+    bs_trace_raw_time(1, "PPI:   ch %2i (%s) -> %s, fork -> %s\n",
+                      ch_nbr, enabled ? "enabled" : "disabled",
+                      ppi_task_name(ppi_ch_tasks[ch_nbr].tep),
+                      ppi_task_name(ppi_ch_tasks[ch_nbr].fork_tep));
+  }
+}
+
+/**
+ * Dump the current routing: for each event, which channels it feeds and
+ * which tasks those trigger.
+ * With the activity counters enabled, also how many times, and when last,
+ * each event was raised, each channel fired and each task was triggered.
+ *
+ * Called at exit with -hw_ppi_stats, but can be called at any point
+ * (for ex. from a test or a debugger).
+ */
+void nrf_ppi_dump(void){
+  bs_trace_raw_time(1, "PPI: routing (CHEN = 0x%08X):\n", NRF_PPI_regs.CHEN);
+
+  for ( unsigned int i = 0 ; i < PPI_N_EVENTS ; i++ ){
+    ppi_event_types_t event = ppi_events_table[i].event_type;
+    uint32_t ch_mask = ppi_evt_to_ch[event].channels_mask;
+
+    if ( ppi_stats != NULL ){
+      if ( ( ch_mask == 0 ) && ( ppi_stats->evt_count[event] == 0 ) ){
+        continue;
+      }
+      bs_trace_raw_time(1, "PPI: %s, raised %"PRIu64" times, last at %"PRItime" us\n",
+                        ppi_events_table[i].name,
+                        ppi_stats->evt_count[event], ppi_stats->evt_last[event]);
+    } else {
+      if ( ch_mask == 0 ){
+        continue;
+      }
+      bs_trace_raw_time(1, "PPI: %s\n", ppi_events_table[i].name);
+    }
+    while ( ch_mask ){
+      int ch_nbr = __builtin_ffs(ch_mask) - 1;
+      ch_mask &= ~( (uint32_t) 1 << ch_nbr );
+      ppi_dump_channel(ch_nbr);
     }
   }
 
-  if (tasks_queue.used >= tasks_queue.size) {
-    tasks_queue.size += TASK_QUEUE_ALLOC_SIZE;
-    tasks_queue.q = bs_realloc(tasks_queue.q, tasks_queue.size*sizeof(dest_f_t));
+  if ( ppi_stats == NULL ){
+    return;
+  }
+  for ( ppi_task_id_t task = 1 ; task <= PPI_N_TASKS ; task++ ){
+    if ( ppi_stats->task_count[task] > 0 ){
+      bs_trace_raw_time(1, "PPI: %s triggered %"PRIu64" times\n",
+                        ppi_task_name(task), ppi_stats->task_count[task]);
+    }
+  }
+  bs_trace_raw_time(1, "PPI: %"PRIu64" task triggers coalesced with an already pending or triggered one\n",
+                    ppi_stats->tasks_coalesced);
+}
+
+static void ppi_call_task(const ppi_tasks_table_t *task){
+  if ( task->dest ){
+    task->dest();
+  } else if ( task->dest_inst ){
+    task->dest_inst(task->inst);
+  } else {
+    task->dest_inst_idx(task->inst, task->idx);
+  }
+}
+
+static void nrf_ppi_enqueue_task(ppi_task_id_t task) {
+  uint64_t bit = (uint64_t)1 << ( task % 64 );
+
+  if ( ( tasks_queue.pending[task / 64] | tasks_queue.triggered[task / 64] ) & bit ){ //We ignore dups
+    if ( ppi_stats != NULL ){
+      ppi_stats->tasks_coalesced++;
+    }
+    return;
   }
-  tasks_queue.q[tasks_queue.used++] = task;
+  tasks_queue.pending[task / 64] |= bit;
+  tasks_queue.q[( tasks_queue.first + tasks_queue.used ) % PPI_N_TASKS] = task;
+  tasks_queue.used++;
 }
 
 static void nrf_ppi_dequeue_all_tasks(void) {
-  int i;
-  for (i = 0; i < tasks_queue.used; i++) {
-    if (tasks_queue.q[i]) {
-      dest_f_t f = tasks_queue.q[i];
-      tasks_queue.q[i] = NULL;
-      f();
+  tasks_queue.draining = true;
+  while ( tasks_queue.used > 0 ) {
+    ppi_task_id_t task = tasks_queue.q[tasks_queue.first];
+    tasks_queue.first = ( tasks_queue.first + 1 ) % PPI_N_TASKS;
+    tasks_queue.used--;
+    tasks_queue.pending[task / 64] &= ~( (uint64_t)1 << ( task % 64 ) );
+    if ( tasks_queue.coalescing ){
+      tasks_queue.triggered[task / 64] |= (uint64_t)1 << ( task % 64 );
+      tasks_queue.any_triggered = true;
+    }
+    if ( ppi_stats != NULL ){
+      ppi_stats->task_count[task]++;
+    }
+    ppi_call_task(&ppi_tasks_table[task - 1]);
+  }
+  tasks_queue.draining = false;
+}
+
+static void ppi_evt_tasks_add(unsigned int first, unsigned int *n, ppi_task_id_t task){
+  if ( task == PPI_NO_TASK ){
+    return;
+  }
+  for ( unsigned int i = first; i < *n; i++ ){
+    if ( ppi_evt_tasks.task[i] == task ){ //We ignore dups
+      return;
+    }
+  }
+  ppi_evt_tasks.task[(*n)++] = task;
+}
+
+static void ppi_build_evt_tasks(void){
+  unsigned int n = 0;
+
+  ppi_evt_tasks.chen = NRF_PPI_regs.CHEN;
+  for ( int event = 0 ; event < NUMBER_PPI_EVENTS ; event++ ){
+    uint32_t ch_mask = ppi_evt_to_ch[event].channels_mask & ppi_evt_tasks.chen;
+
+    ppi_evt_tasks.first[event] = n;
+    while ( ch_mask ){
+      int ch_nbr = __builtin_ffs(ch_mask) - 1;
+      ch_mask &= ~( (uint32_t) 1 << ch_nbr );
+      ppi_evt_tasks_add(ppi_evt_tasks.first[event], &n, ppi_ch_tasks[ch_nbr].tep);
+      ppi_evt_tasks_add(ppi_evt_tasks.first[event], &n, ppi_ch_tasks[ch_nbr].fork_tep);
     }
   }
-  tasks_queue.used = 0;
+  ppi_evt_tasks.first[NUMBER_PPI_EVENTS] = n;
+  ppi_evt_tasks.valid = true;
+}
+
+static void ppi_stats_event(ppi_event_types_t event){
+  bs_time_t now = tm_get_hw_time();
+  uint32_t ch_mask = ppi_evt_to_ch[event].channels_mask & NRF_PPI_regs.CHEN;
+
+  ppi_stats->evt_count[event]++;
+  ppi_stats->evt_last[event] = now;
+  while ( ch_mask ){
+    int ch_nbr = __builtin_ffs(ch_mask) - 1;
+    ch_mask &= ~( (uint32_t) 1 << ch_nbr );
+    ppi_stats->ch_count[ch_nbr]++;
+    ppi_stats->ch_last[ch_nbr] = now;
+  }
 }
 
 /**
@@ -680,47 +740,65 @@ static void nrf_ppi_dequeue_all_tasks(void) {
  */
 void nrf_ppi_event(ppi_event_types_t event){
 
-  uint32_t ch_mask = ppi_evt_to_ch[event].channels_mask;
-  ch_mask &= NRF_PPI_regs.CHEN;
-
-  if ( ch_mask ){
-    for ( int ch_nbr = __builtin_ffs(ch_mask) - 1;
-          ( ch_mask != 0 ) && ( ch_nbr < NUMBER_PPI_CHANNELS ) ;
-          ch_nbr++ ) {
-      if ( ch_mask & ( 1 << ch_nbr ) ){
-        ch_mask &= ~( (uint64_t) 1 << ch_nbr );
-        if ( ppi_ch_tasks[ch_nbr].tep_f != NULL ){
-          nrf_ppi_enqueue_task(ppi_ch_tasks[ch_nbr].tep_f);
-        }
-        if ( ppi_ch_tasks[ch_nbr].fork_tep_f != NULL ){
-          nrf_ppi_enqueue_task(ppi_ch_tasks[ch_nbr].fork_tep_f);
-        }
-      } //if event is mapped to this channel
-    } //for channels
-    nrf_ppi_dequeue_all_tasks();
+  if ( ppi_stats != NULL ){
+    ppi_stats_event(event);
+  }
+
+  if ( !ppi_evt_tasks.valid || ( ppi_evt_tasks.chen != NRF_PPI_regs.CHEN ) ){
+    ppi_build_evt_tasks();
+  }
+
+  unsigned int first = ppi_evt_tasks.first[event];
+  unsigned int last = ppi_evt_tasks.first[event + 1];
+
+  if ( first != last ){
+    for ( unsigned int i = first ; i < last ; i++ ){
+      nrf_ppi_enqueue_task(ppi_evt_tasks.task[i]);
+    }
+    //Otherwise the ongoing loop will execute them
+    if ( !tasks_queue.draining ){
+      nrf_hw_sched_defer_begin();
+      nrf_ppi_dequeue_all_tasks();
+      nrf_hw_sched_defer_end();
+    }
   } //if this event is in any channel
 }
 
+/**
+ * Start a coalescing window: Until nrf_ppi_coalesce_end(), a task is only
+ * triggered by the first event which reaches it
+ *
+ * Called by the HW models top before dispatching a peripheral event handler
+ */
+void nrf_ppi_coalesce_begin(void){
+  if ( tasks_queue.any_triggered ){
+    memset(tasks_queue.triggered, 0, sizeof(tasks_queue.triggered));
+    tasks_queue.any_triggered = false;
+  }
+  tasks_queue.coalescing = true;
+}
+
+/**
+ * End the coalescing window started by nrf_ppi_coalesce_begin()
+ */
+void nrf_ppi_coalesce_end(void){
+  tasks_queue.coalescing = false;
+}
+
 /**
  * Find the task in ppi_tasks_table whose address
- * matches <TEP> and save the task handling function <in dest>
+ * matches <TEP> and save its id in <dest>
  *
  * Helper function for the TEP and FORK_TEP functions
  */
-static void find_task(void *TEP, dest_f_t *dest, int ch_nbr){
-  int tt = 0;
-  while ( ppi_tasks_table[tt].task_addr != NULL ){
-    if ( ppi_tasks_table[tt].task_addr == TEP ){
-       *dest = ppi_tasks_table[tt].dest;
-       return;
-    }
-    tt++;
+static void find_task(void *TEP, ppi_task_id_t *dest, int ch_nbr){
+  *dest = ppi_task_id_by_addr(TEP);
+  if ( *dest != PPI_NO_TASK ){
+    return;
   }
   bs_trace_warning_line_time(
       "NRF_PPI: The task %p for chnbr %i does not match any modelled task in NRF_PPI.c => it will be ignored\n",
       TEP, ch_nbr);
-
-  *dest = NULL;
 }
 
 /**
@@ -731,20 +809,20 @@ void nrf_ppi_regw_sideeffects_EEP(int ch_nbr){
   //To save execution time when an event is raised, we build the
   //ppi_event_config_table & ppi_channel_config_table out of the registers
 
-  //first remove this channel from all events masks
-  for (int i = 0 ; i < NUMBER_PPI_EVENTS ; i++){
-    ppi_evt_to_ch[i].channels_mask &= ~( 1 << ch_nbr );
+  //first remove this channel from the mask of the event which was feeding it
+  if ( ppi_ch_to_evt[ch_nbr] != NUMBER_PPI_EVENTS ){
+    ppi_evt_to_ch[ppi_ch_to_evt[ch_nbr]].channels_mask &= ~( 1 << ch_nbr );
+    ppi_ch_to_evt[ch_nbr] = NUMBER_PPI_EVENTS;
   }
+  ppi_evt_tasks.valid = false;
 
   //then lets try to find which event (if any) is feeding this channel
   if ( ( ch_nbr < 20 ) && ( (void*)NRF_PPI_regs.CH[ch_nbr].EEP != NULL ) ){
-    int i = 0;
-    while ( ppi_events_table[i].event_type != NUMBER_PPI_EVENTS ){
-      if ( ppi_events_table[i].event_addr == (void*)NRF_PPI_regs.CH[ch_nbr].EEP ) {
-        ppi_evt_to_ch[ppi_events_table[i].event_type].channels_mask |= ( 1 << ch_nbr );
-        return;
-      }
-      i++;
+    const ppi_event_table_t *event = ppi_event_by_addr((void*)NRF_PPI_regs.CH[ch_nbr].EEP);
+    if ( event != NULL ){
+      ppi_evt_to_ch[event->event_type].channels_mask |= ( 1 << ch_nbr );
+      ppi_ch_to_evt[ch_nbr] = event->event_type;
+      return;
     }
     bs_trace_warning_line_time(
         "NRF_PPI: The event NRF_PPI_regs.CH[%i].EEP(=%p) does not match any modelled event in NRF_PPI.c=> it will be ignored\n",
@@ -759,13 +837,14 @@ void nrf_ppi_regw_sideeffects_EEP(int ch_nbr){
 void nrf_ppi_regw_sideeffects_TEP(int ch_nbr){
   //To save execution time when an event is raised, we build the
   //ppi_event_config_table & ppi_channel_config_table out of the registers
+  ppi_evt_tasks.valid = false;
   if ( ch_nbr < 20 ){
     if ( (void*)NRF_PPI_regs.CH[ch_nbr].TEP != NULL ){
       find_task((void*)NRF_PPI_regs.CH[ch_nbr].TEP,
-                &ppi_ch_tasks[ch_nbr].tep_f,
+                &ppi_ch_tasks[ch_nbr].tep,
                 ch_nbr);
     } else {
-      ppi_ch_tasks[ch_nbr].tep_f = NULL;
+      ppi_ch_tasks[ch_nbr].tep = PPI_NO_TASK;
     }
   }
 }
@@ -774,12 +853,24 @@ void nrf_ppi_regw_sideeffects_TEP(int ch_nbr){
  * FORK[<ch_nbr>].TEP update
  */
 void nrf_ppi_regw_sideeffects_FORK_TEP(int ch_nbr){
+  ppi_evt_tasks.valid = false;
   if ( (void*)NRF_PPI_regs.FORK[ch_nbr].TEP != NULL ){
     find_task((void*)NRF_PPI_regs.FORK[ch_nbr].TEP,
-              &ppi_ch_tasks[ch_nbr].fork_tep_f,
+              &ppi_ch_tasks[ch_nbr].fork_tep,
               ch_nbr);
   } else {
-    ppi_ch_tasks[ch_nbr].fork_tep_f = NULL;
+    ppi_ch_tasks[ch_nbr].fork_tep = PPI_NO_TASK;
+  }
+}
+
+/**
+ * Rebuild the PPI tasks routing out of the registers
+ * after they have been restored from a snapshot
+ */
+void nrf_ppi_snapshot_restore(void){
+  for (int ch_nbr = 0; ch_nbr < NUMBER_PPI_CHANNELS; ch_nbr++){
+    nrf_ppi_regw_sideeffects_TEP(ch_nbr);
+    nrf_ppi_regw_sideeffects_FORK_TEP(ch_nbr);
   }
 }
 
@@ -861,3 +952,66 @@ void nrf_ppi_taskw_sideeffects(){
 		nrf_ppi_regw_sideeffects_TASKS_CHG_EN(i);
 	}
 }
+
+#if defined(__TEST_PPI_ADDR_LOOKUP)
+/*
+ * Hooks for the TEP/EEP lookups check and benchmark in bench/ (which builds
+ * this file with -D__TEST_PPI_ADDR_LOOKUP): the hash lookups vs the linear
+ * search of the tables they replaced
+ */
+#include <stdlib.h>
+
+static ppi_task_id_t linear_task_id_by_addr(void *addr){
+  for ( unsigned int i = 0 ; i < PPI_N_TASKS; i++ ){
+    if ( ppi_tasks_table[i].task_addr == addr ){
+      return i + 1;
+    }
+  }
+  return PPI_NO_TASK;
+}
+
+static const ppi_event_table_t *linear_event_by_addr(void *addr){
+  for ( unsigned int i = 0 ; i < PPI_N_EVENTS; i++ ){
+    if ( ppi_events_table[i].event_addr == addr ){
+      return &ppi_events_table[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Fill <teps> and <eeps> with <n> random task and event addresses,
+ * 1 in 16 of them an address which is not a task/event
+ */
+void nrf_ppi_test_random_addrs(void **teps, void **eeps, unsigned int n){
+  for ( unsigned int i = 0; i < n; i++ ){
+    if ( rand() % 16 == 0 ){
+      teps[i] = (void*)(uintptr_t)(4*(rand() + 1));
+      eeps[i] = (void*)(uintptr_t)(4*(rand() + 1));
+    } else {
+      teps[i] = ppi_tasks_table[rand() % PPI_N_TASKS].task_addr;
+      eeps[i] = ppi_events_table[rand() % PPI_N_EVENTS].event_addr;
+    }
+  }
+}
+
+/**
+ * Look up <tep> and <eep>, with the hash tables or (<linear>) with a linear
+ * search. Returns a value which depends on both results
+ */
+uintptr_t nrf_ppi_test_lookup(void *tep, void *eep, bool linear){
+  if ( linear ){
+    return linear_task_id_by_addr(tep) + (uintptr_t)linear_event_by_addr(eep);
+  } else {
+    return ppi_task_id_by_addr(tep) + (uintptr_t)ppi_event_by_addr(eep);
+  }
+}
+
+/**
+ * Check the hash lookups of <tep> and <eep> find the same as the linear search
+ */
+bool nrf_ppi_test_lookup_match(void *tep, void *eep){
+  return ( ppi_task_id_by_addr(tep) == linear_task_id_by_addr(tep) )
+         && ( ppi_event_by_addr(eep) == linear_event_by_addr(eep) );
+}
+#endif //defined(__TEST_PPI_ADDR_LOOKUP)
@@ -7,11 +7,16 @@
 #define _NRF_HW_MODEL_PPI_H
 
 #include "nrfx.h"
+#include "NRF_EGU.h"
+#include "NRF_TIMER.h"
 
 #ifdef __cplusplus
 extern "C"{
 #endif
 
+#define NRF_PPI_EGU_EVENT(inst, n) EGU##inst##_EVENTS_TRIGGERED_##n,
+#define NRF_PPI_TIMER_EVENT(t, cc) TIMER##t##_EVENTS_COMPARE_##cc,
+
 //Signals/Events types HW models may send to the PPI
 typedef enum { //Note that, for performance, it is better to leave commented the unused ones
   //0 0x40000000 CLOCK
@@ -89,28 +94,13 @@ typedef enum { //Note that, for performance, it is better to leave commented the
 
   //8 0x40008000 TIMER0
   //TIMER
-  TIMER0_EVENTS_COMPARE_0 ,
-  TIMER0_EVENTS_COMPARE_1 ,
-  TIMER0_EVENTS_COMPARE_2 ,
-  TIMER0_EVENTS_COMPARE_3 ,
-//  TIMER0_EVENTS_COMPARE_4 ,
-//  TIMER0_EVENTS_COMPARE_5 ,
+  NRF_TIMER_FOR_EACH_CC(NRF_PPI_TIMER_EVENT, 0)
 
 //9 0x40009000 Timer 1
-  TIMER1_EVENTS_COMPARE_0 ,
-  TIMER1_EVENTS_COMPARE_1 ,
-  TIMER1_EVENTS_COMPARE_2 ,
-  TIMER1_EVENTS_COMPARE_3 ,
-//  TIMER1_EVENTS_COMPARE_4 ,
-//  TIMER1_EVENTS_COMPARE_5 ,
+  NRF_TIMER_FOR_EACH_CC(NRF_PPI_TIMER_EVENT, 1)
 
 //10 0x4000A000 Timer 2
-  TIMER2_EVENTS_COMPARE_0 ,
-  TIMER2_EVENTS_COMPARE_1 ,
-  TIMER2_EVENTS_COMPARE_2 ,
-  TIMER2_EVENTS_COMPARE_3 ,
-//  TIMER2_EVENTS_COMPARE_4 ,
-//  TIMER2_EVENTS_COMPARE_5 ,
+  NRF_TIMER_FOR_EACH_CC(NRF_PPI_TIMER_EVENT, 2)
 
 
   //11 0x4000B000 RTC0
@@ -156,130 +146,15 @@ typedef enum { //Note that, for performance, it is better to leave commented the
 //  18 0x40012000 QDEC
 //  19 0x40013000 LPCOMP
 //  19 0x40013000 COMP
-//  20 0x40014000 EGU
-  EGU0_EVENTS_TRIGGERED_0, //Careful!: These EGU events (inside each instance) are assumed consecutive in the EGU model
-  EGU0_EVENTS_TRIGGERED_1,
-  EGU0_EVENTS_TRIGGERED_2,
-  EGU0_EVENTS_TRIGGERED_3,
-  EGU0_EVENTS_TRIGGERED_4,
-  EGU0_EVENTS_TRIGGERED_5,
-  EGU0_EVENTS_TRIGGERED_6,
-  EGU0_EVENTS_TRIGGERED_7,
-  EGU0_EVENTS_TRIGGERED_8,
-  EGU0_EVENTS_TRIGGERED_9,
-  EGU0_EVENTS_TRIGGERED_10,
-  EGU0_EVENTS_TRIGGERED_11,
-  EGU0_EVENTS_TRIGGERED_12,
-  EGU0_EVENTS_TRIGGERED_13,
-  EGU0_EVENTS_TRIGGERED_14,
-  EGU0_EVENTS_TRIGGERED_15,
-//  20 0x40014000 SWI
-//  21 0x40015000 EGU
-  EGU1_EVENTS_TRIGGERED_0,
-  EGU1_EVENTS_TRIGGERED_1,
-  EGU1_EVENTS_TRIGGERED_2,
-  EGU1_EVENTS_TRIGGERED_3,
-  EGU1_EVENTS_TRIGGERED_4,
-  EGU1_EVENTS_TRIGGERED_5,
-  EGU1_EVENTS_TRIGGERED_6,
-  EGU1_EVENTS_TRIGGERED_7,
-  EGU1_EVENTS_TRIGGERED_8,
-  EGU1_EVENTS_TRIGGERED_9,
-  EGU1_EVENTS_TRIGGERED_10,
-  EGU1_EVENTS_TRIGGERED_11,
-  EGU1_EVENTS_TRIGGERED_12,
-  EGU1_EVENTS_TRIGGERED_13,
-  EGU1_EVENTS_TRIGGERED_14,
-  EGU1_EVENTS_TRIGGERED_15,
-//  21 0x40015000 SWI
-//  22 0x40016000 EGU
-  EGU2_EVENTS_TRIGGERED_0,
-  EGU2_EVENTS_TRIGGERED_1,
-  EGU2_EVENTS_TRIGGERED_2,
-  EGU2_EVENTS_TRIGGERED_3,
-  EGU2_EVENTS_TRIGGERED_4,
-  EGU2_EVENTS_TRIGGERED_5,
-  EGU2_EVENTS_TRIGGERED_6,
-  EGU2_EVENTS_TRIGGERED_7,
-  EGU2_EVENTS_TRIGGERED_8,
-  EGU2_EVENTS_TRIGGERED_9,
-  EGU2_EVENTS_TRIGGERED_10,
-  EGU2_EVENTS_TRIGGERED_11,
-  EGU2_EVENTS_TRIGGERED_12,
-  EGU2_EVENTS_TRIGGERED_13,
-  EGU2_EVENTS_TRIGGERED_14,
-  EGU2_EVENTS_TRIGGERED_15,
-//  22 0x40016000 SWI
-//  23 0x40017000 EGU
-  EGU3_EVENTS_TRIGGERED_0,
-  EGU3_EVENTS_TRIGGERED_1,
-  EGU3_EVENTS_TRIGGERED_2,
-  EGU3_EVENTS_TRIGGERED_3,
-  EGU3_EVENTS_TRIGGERED_4,
-  EGU3_EVENTS_TRIGGERED_5,
-  EGU3_EVENTS_TRIGGERED_6,
-  EGU3_EVENTS_TRIGGERED_7,
-  EGU3_EVENTS_TRIGGERED_8,
-  EGU3_EVENTS_TRIGGERED_9,
-  EGU3_EVENTS_TRIGGERED_10,
-  EGU3_EVENTS_TRIGGERED_11,
-  EGU3_EVENTS_TRIGGERED_12,
-  EGU3_EVENTS_TRIGGERED_13,
-  EGU3_EVENTS_TRIGGERED_14,
-  EGU3_EVENTS_TRIGGERED_15,
-//  23 0x40017000 SWI
-//  24 0x40018000 SWI
-//  24 0x40018000 EGU
-  EGU4_EVENTS_TRIGGERED_0,
-  EGU4_EVENTS_TRIGGERED_1,
-  EGU4_EVENTS_TRIGGERED_2,
-  EGU4_EVENTS_TRIGGERED_3,
-  EGU4_EVENTS_TRIGGERED_4,
-  EGU4_EVENTS_TRIGGERED_5,
-  EGU4_EVENTS_TRIGGERED_6,
-  EGU4_EVENTS_TRIGGERED_7,
-  EGU4_EVENTS_TRIGGERED_8,
-  EGU4_EVENTS_TRIGGERED_9,
-  EGU4_EVENTS_TRIGGERED_10,
-  EGU4_EVENTS_TRIGGERED_11,
-  EGU4_EVENTS_TRIGGERED_12,
-  EGU4_EVENTS_TRIGGERED_13,
-  EGU4_EVENTS_TRIGGERED_14,
-  EGU4_EVENTS_TRIGGERED_15,
-//  25 0x40019000 SWI
-//  25 0x40019000 EGU
-  EGU5_EVENTS_TRIGGERED_0,
-  EGU5_EVENTS_TRIGGERED_1,
-  EGU5_EVENTS_TRIGGERED_2,
-  EGU5_EVENTS_TRIGGERED_3,
-  EGU5_EVENTS_TRIGGERED_4,
-  EGU5_EVENTS_TRIGGERED_5,
-  EGU5_EVENTS_TRIGGERED_6,
-  EGU5_EVENTS_TRIGGERED_7,
-  EGU5_EVENTS_TRIGGERED_8,
-  EGU5_EVENTS_TRIGGERED_9,
-  EGU5_EVENTS_TRIGGERED_10,
-  EGU5_EVENTS_TRIGGERED_11,
-  EGU5_EVENTS_TRIGGERED_12,
-  EGU5_EVENTS_TRIGGERED_13,
-  EGU5_EVENTS_TRIGGERED_14,
-  EGU5_EVENTS_TRIGGERED_15,
+//  20 0x40014000 EGU .. 25 0x40019000 EGU
+//  (EGU<inst>_EVENTS_TRIGGERED_<n>, see NRF_EGU.h)
+  NRF_EGU_FOR_EACH_TRIGGER(NRF_PPI_EGU_EVENT) //Careful!: These EGU events (inside each instance) are assumed consecutive in the EGU model
 
 //  26 0x4001A000 TIMER3
-    TIMER3_EVENTS_COMPARE_0 ,
-    TIMER3_EVENTS_COMPARE_1 ,
-    TIMER3_EVENTS_COMPARE_2 ,
-    TIMER3_EVENTS_COMPARE_3 ,
-    TIMER3_EVENTS_COMPARE_4 ,
-    TIMER3_EVENTS_COMPARE_5 ,
+    NRF_TIMER_FOR_EACH_CC(NRF_PPI_TIMER_EVENT, 3)
 
 //  27 0x4001B000 TIMER4
-    TIMER4_EVENTS_COMPARE_0 ,
-    TIMER4_EVENTS_COMPARE_1 ,
-    TIMER4_EVENTS_COMPARE_2 ,
-    TIMER4_EVENTS_COMPARE_3 ,
-    TIMER4_EVENTS_COMPARE_4 ,
-    TIMER4_EVENTS_COMPARE_5 ,
+    NRF_TIMER_FOR_EACH_CC(NRF_PPI_TIMER_EVENT, 4)
 
 //  28 0x4001C000 PWM
 //  29 0x4001D000 PDM
@@ -325,16 +200,27 @@ typedef enum { //Note that, for performance, it is better to leave commented the
 
 void nrf_ppi_init();
 void nrf_ppi_clean_up();
+void nrf_ppi_stats_enable(bool enable);
+void nrf_ppi_dump(void);
 void nrf_ppi_event(ppi_event_types_t event);
+void nrf_ppi_coalesce_begin(void);
+void nrf_ppi_coalesce_end(void);
 void nrf_ppi_regw_sideeffects();
 void nrf_ppi_regw_sideeffects_TEP(int ch_nbr);
 void nrf_ppi_regw_sideeffects_EEP(int ch_nbr);
 void nrf_ppi_regw_sideeffects_FORK_TEP(int ch_nbr);
+void nrf_ppi_snapshot_restore(void);
 void nrf_ppi_regw_sideeffects_TASKS_CHG_DIS(int i);
 void nrf_ppi_regw_sideeffects_TASKS_CHG_EN(int i);
 void nrf_ppi_regw_sideeffects_CHENSET();
 void nrf_ppi_regw_sideeffects_CHENCLR();
 
+#if defined(__TEST_PPI_ADDR_LOOKUP)
+void nrf_ppi_test_random_addrs(void **teps, void **eeps, unsigned int n);
+uintptr_t nrf_ppi_test_lookup(void *tep, void *eep, bool linear);
+bool nrf_ppi_test_lookup_match(void *tep, void *eep);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
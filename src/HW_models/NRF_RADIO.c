@@ -33,10 +33,10 @@
  *           if CRCINC==1, the CRC LEN is deducted from the length field, before MAXLEN is checked.
  *           It is unclear from the spec if this is the real HW behaviour
  *
- * Note11: Only the BLE & 15.4 CRC polynomials are supported
- *         During reception we assume that CRCPOLY and CRCINIT are correct on both sides, and just rely on the phy bit error reporting to save processing time
+ * Note11: During reception we assume that CRCPOLY and CRCINIT are correct on both sides, and just rely on the phy bit error reporting to save processing time
  *         On transmission we generate the correct CRC for correctness of the channel dump traces (and Ellisys traces)
- * Note11b:The CRC configuration is directly deduced from the modulation, only BLE and 154 CRCs are supported so far
+ * Note11b:On transmission the CRC is calculated as configured in CRCCNF, CRCPOLY and CRCINIT (any polynomial and length).
+ *         But CRCCNF.SKIPADDR = Include is not modeled: the address is never included in the CRC
  *
  * Note12: * CCA or ED procedures cannot be performed while the RADIO is performing an actual packet reception (they are exclusive)
  *         * In CCA Mode2 & 3, this model (due to the Phy) does not search for a SFD, or for a correlation peak
@@ -52,7 +52,9 @@
  *
  * Note16: No antenna switching
  *
- * Note17: Interrupts are modeled as pulses to the NVIC, not level interrupts as they are in reality
+ * Note17: The interrupt is modeled as a level interrupt line to the NVIC, as it is in reality.
+ *         As the SW may clear the events by just writing to their registers, the line is also
+ *         re-evaluated when the NVIC checks it (see hw_irq_ctrl_set_line_eval())
  *
  * Note18: EVENTS_SYNC:
  *         a) It is not generated at the exact correct time:
@@ -159,38 +161,40 @@
 #include "NRF_RADIO_timings.h"
 #include "NRF_RADIO_bitcounter.h"
 #include "NRF_RADIO_priv.h"
+#include "NRF_HW_ctx.h"
 
-NRF_RADIO_Type NRF_RADIO_regs;
-uint32_t NRF_RADIO_INTEN = 0; //interrupt enable (global for RADIO_signals.c)
+NRF_HW_STATE NRF_RADIO_Type NRF_RADIO_regs;
+NRF_HW_STATE uint32_t NRF_RADIO_INTEN = 0; //interrupt enable (global for RADIO_signals.c)
 
-bs_time_t Timer_RADIO = TIME_NEVER; //main radio timer
-bs_time_t Timer_RADIO_abort_reeval = TIME_NEVER; //Abort reevaluation response timer, this timer must have the lowest priority of all events (which may cause an abort)
+NRF_HW_STATE bs_time_t Timer_RADIO = TIME_NEVER; //main radio timer
+NRF_HW_STATE bs_time_t Timer_RADIO_abort_reeval = TIME_NEVER; //Abort reevaluation response timer, this timer must have the lowest priority of all events (which may cause an abort)
+static NRF_HW_STATE nrf_hw_timer_handle_t RADIO_timer;
+static NRF_HW_STATE nrf_hw_timer_handle_t RADIO_abort_reeval_timer;
 
-static TIFS_state_t TIFS_state = TIFS_DISABLE;
-static bool TIFS_ToTxNotRx = false; //Are we in a TIFS automatically starting a Tx from a Rx (true), or Rx from Tx (false)
-static bs_time_t Timer_TIFS = TIME_NEVER;
-static bool from_hw_tifs = false; /* Unfortunate hack due to the SW racing the HW to clear SHORTS*/
+static NRF_HW_STATE TIFS_state_t TIFS_state = TIFS_DISABLE;
+static NRF_HW_STATE bool TIFS_ToTxNotRx = false; //Are we in a TIFS automatically starting a Tx from a Rx (true), or Rx from Tx (false)
+static NRF_HW_STATE bs_time_t Timer_TIFS = TIME_NEVER;
+static NRF_HW_STATE bool from_hw_tifs = false; /* Unfortunate hack due to the SW racing the HW to clear SHORTS*/
 
-static RADIO_Rx_status_t rx_status;
-static RADIO_Tx_status_t tx_status;
-static RADIO_CCA_status_t cca_status;
+static NRF_HW_STATE RADIO_Rx_status_t rx_status;
+static NRF_HW_STATE RADIO_Tx_status_t tx_status;
+static NRF_HW_STATE RADIO_CCA_status_t cca_status;
 
-static double bits_per_us; //Bits per us for the ongoing Tx or Rx
+static NRF_HW_STATE double bits_per_us; //Bits per us for the ongoing Tx or Rx
 
-static bs_time_t next_recheck_time; // when we asked the phy to recheck (in our own time) next time
-static abort_state_t abort_fsm_state = No_pending_abort_reeval; //This variable shall be set to Tx/Rx_Abort_reeval when the phy is waiting for an abort response (and in no other circumstance)
-static int aborting_set = 0; //If set, we will abort the current Tx/Rx/CCA at the next abort reevaluation
+static NRF_HW_STATE bs_time_t next_recheck_time; // when we asked the phy to recheck (in our own time) next time
+static NRF_HW_STATE abort_state_t abort_fsm_state = No_pending_abort_reeval; //This variable shall be set to Tx/Rx_Abort_reeval when the phy is waiting for an abort response (and in no other circumstance)
+static NRF_HW_STATE int aborting_set = 0; //If set, we will abort the current Tx/Rx/CCA at the next abort reevaluation
 
-static nrfra_state_t radio_state;
-static nrfra_sub_state_t radio_sub_state;
+static NRF_HW_STATE nrfra_state_t radio_state;
+static NRF_HW_STATE nrfra_sub_state_t radio_sub_state;
 
-static uint8_t tx_buf[_NRF_MAX_PACKET_SIZE]; //starting from the header, and including CRC
-static uint8_t rx_buf[_NRF_MAX_PACKET_SIZE]; // "
-static uint8_t *rx_pkt_buffer_ptr = (uint8_t*)&rx_buf;
+static NRF_HW_STATE uint8_t rx_buf[_NRF_MAX_PACKET_SIZE]; //starting from the header, and including CRC
+static NRF_HW_STATE_LOCAL uint8_t *rx_pkt_buffer_ptr = (uint8_t*)&rx_buf;
 
-static bool radio_on = false;
+static NRF_HW_STATE bool radio_on = false;
 
-static bool rssi_sampling_on = false;
+static NRF_HW_STATE bool rssi_sampling_on = false;
 
 static void start_Tx();
 static void start_Rx();
@@ -200,6 +204,7 @@ static void Tx_abort_eval_respond();
 static void Rx_abort_eval_respond();
 static void CCA_abort_eval_respond();
 static void nrf_radio_device_address_match();
+static void nrf_radio_irq_line_eval(unsigned int irq);
 
 static void radio_reset() {
   memset(&NRF_RADIO_regs, 0, sizeof(NRF_RADIO_regs));
@@ -227,11 +232,20 @@ static void radio_reset() {
     NRF_RADIO_regs.PSEL.DFEGPIO[i] = 0xFFFFFFFF;
   NRF_RADIO_regs.DFEPACKET.MAXCNT = 0x00001000;
   NRF_RADIO_regs.POWER = 1;
+
+  nrf_radio_eval_interrupt();
 }
 
 void nrf_radio_init() {
+  RADIO_timer = nrf_hw_timer_register("RADIO timer", NRF_HW_TIMER_PRIO_RADIO, nrf_radio_timer_triggered);
+  RADIO_abort_reeval_timer = nrf_hw_timer_register("RADIO abort reeval timer",
+                                                   NRF_HW_TIMER_PRIO_RADIO_ABORT_REEVAL,
+                                                   nrf_radio_timer_abort_reeval_triggered);
+  nrf_radio_bitcounter_init();
+
   nrfra_timings_init();
   radio_reset();
+  hw_irq_ctrl_set_line_eval(RADIO_IRQn, nrf_radio_irq_line_eval);
   radio_on = false;
   bits_per_us = 1;
 }
@@ -246,12 +260,12 @@ double nrf_radio_get_bpus(){
 
 static inline void nrfra_set_Timer_RADIO(bs_time_t t){
   Timer_RADIO = t;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RADIO_timer, Timer_RADIO);
 }
 
 static inline void nrfra_set_Timer_abort_reeval(bs_time_t t){
   Timer_RADIO_abort_reeval = t;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RADIO_abort_reeval_timer, Timer_RADIO_abort_reeval);
 }
 
 void nrf_radio_tasks_TXEN() {
@@ -298,7 +312,7 @@ static void abort_if_needed(){
    */
   if ( radio_sub_state == RX_WAIT_FOR_ADDRESS_END ){
     //we answer immediately to the phy rejecting the packet
-    p2G4_dev_rxv2_cont_after_addr_nc_b(false, NULL);
+    hwll_rxv2_cont_after_addr(false, NULL);
     radio_sub_state = SUB_STATE_INVALID;
   }
 }
@@ -460,6 +474,7 @@ void nrf_radio_regw_sideeffects_INTENSET(){
   if ( NRF_RADIO_regs.INTENSET ){
     NRF_RADIO_INTEN |= NRF_RADIO_regs.INTENSET;
     NRF_RADIO_regs.INTENSET = NRF_RADIO_INTEN;
+    nrf_radio_eval_interrupt();
   }
 }
 
@@ -468,9 +483,18 @@ void nrf_radio_regw_sideeffects_INTENCLR(){
     NRF_RADIO_INTEN  &= ~NRF_RADIO_regs.INTENCLR;
     NRF_RADIO_regs.INTENSET = NRF_RADIO_INTEN;
     NRF_RADIO_regs.INTENCLR = 0;
+    nrf_radio_eval_interrupt();
   }
 }
 
+void nrf_radio_regw_sideeffects_EVENTS_all(){
+  nrf_radio_eval_interrupt();
+}
+
+static void nrf_radio_irq_line_eval(unsigned int irq){
+  nrf_radio_eval_interrupt();
+}
+
 void nrf_radio_regw_sideeffects_POWER(){
   if ( NRF_RADIO_regs.POWER == 0 ){
     radio_on = false;
@@ -479,7 +503,7 @@ void nrf_radio_regw_sideeffects_POWER(){
       radio_on = true;
       abort_if_needed();
       radio_reset();
-      nrf_hw_find_next_timer_to_trigger();
+      nrf_hw_timer_update(RADIO_timer, Timer_RADIO);
     }
   }
 }
@@ -572,7 +596,6 @@ void nrf_radio_timer_triggered(){
   } else if ( radio_state == RAD_RX ){
     if ( radio_sub_state == RX_WAIT_FOR_ADDRESS_END ) {
       nrfra_set_Timer_RADIO(TIME_NEVER);
-      nrf_hw_find_next_timer_to_trigger();
       nrf_radio_signal_SYNC(); //See note on EVENTS_SYNC
       nrf_radio_signal_ADDRESS();
       nrf_radio_signal_FRAMESTART(); //See note on FRAMESTART
@@ -716,7 +739,7 @@ static void Tx_abort_eval_respond(){
 
   update_abort_struct(abort, &next_recheck_time);
 
-  int ret = p2G4_dev_provide_new_tx_abort_nc_b(abort);
+  int ret = hwll_provide_new_tx_abort(abort);
 
   handle_Tx_response(ret);
 }
@@ -755,18 +778,19 @@ static void start_Tx(){
     bits_per_us = 0.25;
   }
 
-  payload_len = nrfra_tx_copy_payload(tx_buf);
+  /* The packet is described as a list of segments pointing to the packet in RAM
+   * (header, and S1 + payload), which are only copied once, into the buffer
+   * handed to the Phy, while calculating the CRC */
+  crc_seg_t tx_segs[2];
+  payload_len = nrfra_tx_packet_segments(tx_segs);
 
-  /* This code should be generalized to support any CRC configuration (CRCCNF, CRCINIT AND CRCPOLY)
-   * When doing so, we should still calculate the ble and 154 crc's with their optimized table implementations
-   * Here we just assume the CRC is configured as it should given the modulation */
   uint32_t crc_init = NRF_RADIO_regs.CRCINIT & RADIO_CRCINIT_CRCINIT_Msk;
-  if ((NRF_RADIO_regs.MODE == RADIO_MODE_MODE_Ble_1Mbit)
-     || (NRF_RADIO_regs.MODE == RADIO_MODE_MODE_Ble_2Mbit) ) {
-    append_crc_ble(tx_buf, header_len + payload_len, crc_init);
-  } else if (NRF_RADIO_regs.MODE == RADIO_MODE_MODE_Ieee802154_250Kbit) {
+  uint32_t crc_poly = NRF_RADIO_regs.CRCPOLY & RADIO_CRCPOLY_CRCPOLY_Msk;
+  if ((NRF_RADIO_regs.MODE == RADIO_MODE_MODE_Ieee802154_250Kbit)
+      || ((NRF_RADIO_regs.CRCCNF & RADIO_CRCCNF_SKIPADDR_Msk)
+          == (RADIO_CRCCNF_SKIPADDR_Ieee802154 << RADIO_CRCCNF_SKIPADDR_Pos))) {
     //15.4 does not CRC the length (header) field
-    append_crc_154(&tx_buf[header_len], payload_len, crc_init);
+    tx_segs[0].crc = false;
   }
 
   bs_time_t packet_duration; //From preamble to CRC
@@ -775,12 +799,15 @@ static void start_Tx(){
   packet_duration /= bits_per_us;
   uint packet_size = header_len + payload_len + crc_len;
 
+  uint8_t *tx_packet = hwll_tx_packet_buf(tx_segs[0].len + tx_segs[1].len + crc_len);
+  crc_gather_append(tx_packet, tx_segs, 2, crc_len, crc_poly, crc_init);
+
   nrfra_prep_tx_request(&tx_status.tx_req, packet_size, packet_duration);
 
   update_abort_struct(&tx_status.tx_req.abort, &next_recheck_time);
 
   //Request the Tx from the Phy:
-  int ret = p2G4_dev_req_txv2_nc_b(&tx_status.tx_req, tx_buf,  &tx_status.tx_resp);
+  int ret = hwll_req_txv2(&tx_status.tx_req, tx_packet,  &tx_status.tx_resp);
   handle_Tx_response(ret);
 
   tx_status.ADDRESS_end_time = tm_get_hw_time() + (bs_time_t)((preamble_len*8 + address_len*8)/bits_per_us) - nrfra_timings_get_TX_chain_delay();
@@ -913,7 +940,7 @@ static void Rx_abort_eval_respond(){
   p2G4_abort_t *abort = &rx_status.rx_req.abort;
   update_abort_struct(abort, &next_recheck_time);
 
-  int ret = p2G4_dev_provide_new_rxv2_abort_nc_b(abort);
+  int ret = hwll_provide_new_rxv2_abort(abort);
 
   handle_Rx_response(ret);
 }
@@ -954,7 +981,7 @@ static void start_Rx(){
   update_abort_struct(&rx_status.rx_req.abort, &next_recheck_time);
 
   //attempt to receive
-  int ret = p2G4_dev_req_rxv2_nc_b(&rx_status.rx_req,
+  int ret = hwll_req_rxv2(&rx_status.rx_req,
       rx_addresses,
       &rx_status.rx_resp,
       &rx_pkt_buffer_ptr,
@@ -997,7 +1024,7 @@ static void Rx_Addr_received(){
   }
 
   update_abort_struct(&rx_status.rx_req.abort, &next_recheck_time);
-  int ret = p2G4_dev_rxv2_cont_after_addr_nc_b(accept_packet, &rx_status.rx_req.abort);
+  int ret = hwll_rxv2_cont_after_addr(accept_packet, &rx_status.rx_req.abort);
 
   if ( accept_packet ){
     handle_Rx_response(ret);
@@ -1117,7 +1144,7 @@ static void CCA_abort_eval_respond(){
 
   update_abort_struct(abort, &next_recheck_time);
 
-  int ret = p2G4_dev_provide_new_cca_abort_nc_b(abort);
+  int ret = hwll_provide_new_cca_abort(abort);
 
   handle_CCA_response(ret);
 }
@@ -1142,6 +1169,6 @@ static void start_CCA_ED(bool CCA_not_ED){
   nrfra_set_Timer_RADIO(cca_status.CCA_end_time);
 
   //Request the CCA from the Phy:
-  int ret = p2G4_dev_req_cca_nc_b(&cca_status.cca_req, &cca_status.cca_resp);
+  int ret = hwll_req_cca(&cca_status.cca_req, &cca_status.cca_resp);
   handle_CCA_response(ret);
 }
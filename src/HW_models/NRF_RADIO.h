@@ -52,6 +52,7 @@ void nrf_radio_regw_sideeffects_TASKS_CCASTART();
 void nrf_radio_regw_sideeffects_TASKS_CCASTOP();
 void nrf_radio_regw_sideeffects_INTENSET();
 void nrf_radio_regw_sideeffects_INTENCLR();
+void nrf_radio_regw_sideeffects_EVENTS_all();
 
 /*
  * Internal interface to bitcounter
@@ -13,14 +13,23 @@
 #include "NRF_RADIO.h"
 #include "NRF_RADIO_signals.h"
 #include "NRF_HW_model_top.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_RADIO_bitcounter = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_RADIO_bitcounter = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t RADIO_bitcounter;
 
-static bs_time_t Time_BitCounterStarted = TIME_NEVER;
-static bool bit_counter_running = false;
+static NRF_HW_STATE bs_time_t Time_BitCounterStarted = TIME_NEVER;
+static NRF_HW_STATE bool bit_counter_running = false;
+
+void nrf_radio_bitcounter_init() {
+  RADIO_bitcounter = nrf_hw_timer_register("RADIO bitcounter timer",
+                                           NRF_HW_TIMER_PRIO_RADIO_BITCOUNTER,
+                                           nrf_radio_bitcounter_timer_triggered);
+}
 
 void nrf_radio_bitcounter_reset() {
   Timer_RADIO_bitcounter = TIME_NEVER;
+  nrf_hw_timer_update(RADIO_bitcounter, Timer_RADIO_bitcounter);
   bit_counter_running = 0;
 }
 
@@ -31,7 +40,7 @@ void nrf_radio_bitcounter_cleanup() {
 void nrf_radio_bitcounter_timer_triggered() {
   nrf_radio_signal_BCMATCH();
   Timer_RADIO_bitcounter = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RADIO_bitcounter, Timer_RADIO_bitcounter);
   //Note that we leave the bit counter running, so a new BCC can be programmed to make it trigger later
 }
 
@@ -46,7 +55,7 @@ void nrf_radio_tasks_BCSTART() {
   bit_counter_running = true;
   Time_BitCounterStarted = tm_get_hw_time();
   Timer_RADIO_bitcounter = Time_BitCounterStarted + NRF_RADIO_regs.BCC/nrf_radio_get_bpus();
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RADIO_bitcounter, Timer_RADIO_bitcounter);
 }
 
 void nrf_radio_stop_bit_counter() {
@@ -56,7 +65,7 @@ void nrf_radio_stop_bit_counter() {
   bit_counter_running = false;
   if (Timer_RADIO_bitcounter != TIME_NEVER) {
     Timer_RADIO_bitcounter = TIME_NEVER;
-    nrf_hw_find_next_timer_to_trigger();
+    nrf_hw_timer_update(RADIO_bitcounter, Timer_RADIO_bitcounter);
   }
 }
 
@@ -75,5 +84,5 @@ void nrf_radio_regw_sideeffects_BCC() {
         Timer_RADIO_bitcounter);
     Timer_RADIO_bitcounter = TIME_NEVER;
   }
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RADIO_bitcounter, Timer_RADIO_bitcounter);
 }
@@ -13,6 +13,7 @@
 extern "C"{
 #endif
 
+void nrf_radio_bitcounter_init();
 void nrf_radio_bitcounter_reset();
 void nrf_radio_bitcounter_cleanup();
 void nrf_radio_stop_bit_counter();
@@ -19,10 +19,43 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
+#include "NRF_HW_ctx.h"
 
 extern uint32_t NRF_RADIO_INTEN; //interrupt enable
 extern void nrf_radio_fake_task_TRXEN_TIFS();
 
+static NRF_HW_STATE bool radio_int_line; /* Is the RADIO currently driving its interrupt line high */
+
+/*
+ * An event enabled in INTEN has just been set,
+ * so the interrupt line is (or stays) high
+ */
+static void nrf_radio_raise_int_line(void){
+  hw_irq_ctrl_update_irq_lines(&radio_int_line, true, RADIO_IRQn);
+}
+
+/*
+ * Re-evaluate the interrupt line level out of the events and INTEN registers
+ * (after the SW changed INTEN or cleared events)
+ *
+ * Note: Each interrupt enable bit corresponds to the event register with that same index
+ */
+void nrf_radio_eval_interrupt(void){
+  volatile uint32_t *events = &NRF_RADIO_regs.EVENTS_READY;
+  uint32_t inten = NRF_RADIO_INTEN;
+  bool new_int_line = false;
+
+  while (inten) {
+    int n = __builtin_ctz(inten);
+    inten &= inten - 1;
+    if (events[n]) {
+      new_int_line = true;
+      break;
+    }
+  }
+  hw_irq_ctrl_update_irq_lines(&radio_int_line, new_int_line, RADIO_IRQn);
+}
+
 void nrf_radio_signal_READY(){
   NRF_RADIO_regs.EVENTS_READY = 1;
   nrf_ppi_event(RADIO_EVENTS_READY);
@@ -35,7 +68,7 @@ void nrf_radio_signal_READY(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_READY_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -51,7 +84,7 @@ void nrf_radio_signal_ADDRESS(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_ADDRESS_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -60,7 +93,7 @@ void nrf_radio_signal_PAYLOAD(){
   nrf_ppi_event(RADIO_EVENTS_PAYLOAD);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_PAYLOAD_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -76,7 +109,7 @@ void nrf_radio_signal_END(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_END_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -111,7 +144,7 @@ void nrf_radio_signal_DISABLED(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_DISABLED_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -120,7 +153,7 @@ void nrf_radio_signal_DEVMATCH() {
   nrf_ppi_event(RADIO_EVENTS_DEVMATCH);
 
   if (NRF_RADIO_INTEN & RADIO_INTENSET_DEVMATCH_Msk) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -129,7 +162,7 @@ void nrf_radio_signal_DEVMISS() {
   nrf_ppi_event(RADIO_EVENTS_DEVMISS);
 
   if (NRF_RADIO_INTEN & RADIO_INTENSET_DEVMISS_Msk) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -138,7 +171,7 @@ void nrf_radio_signal_RSSIEND(){
   nrf_ppi_event(RADIO_EVENTS_RSSIEND);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_RSSIEND_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -147,7 +180,7 @@ void nrf_radio_signal_BCMATCH() {
   nrf_ppi_event(RADIO_EVENTS_BCMATCH);
 
   if (NRF_RADIO_INTEN & RADIO_INTENSET_BCMATCH_Msk) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -156,7 +189,7 @@ void nrf_radio_signal_CRCOK(){
   nrf_ppi_event(RADIO_EVENTS_CRCOK);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CRCOK_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -165,7 +198,7 @@ void nrf_radio_signal_CRCERROR(){
   nrf_ppi_event(RADIO_EVENTS_CRCERROR);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CRCERROR_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -178,7 +211,7 @@ void nrf_radio_signal_FRAMESTART(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_FRAMESTART_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -191,7 +224,7 @@ void nrf_radio_signal_EDEND(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_EDEND_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -200,7 +233,7 @@ void nrf_radio_signal_EDSTOPPED(){
   nrf_ppi_event(RADIO_EVENTS_EDSTOPPED);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_EDSTOPPED_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -216,7 +249,7 @@ void nrf_radio_signal_CCAIDLE(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CCAIDLE_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -229,7 +262,7 @@ void nrf_radio_signal_CCABUSY(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CCABUSY_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -238,7 +271,7 @@ void nrf_radio_signal_CCASTOPPED(){
   nrf_ppi_event(RADIO_EVENTS_CCASTOPPED);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CCASTOPPED_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -247,7 +280,7 @@ void nrf_radio_signal_RATEBOOST(){
   nrf_ppi_event(RADIO_EVENTS_RATEBOOST);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_RATEBOOST_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -260,7 +293,7 @@ void nrf_radio_signal_TXREADY(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_TXREADY_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -276,7 +309,7 @@ void nrf_radio_signal_RXREADY(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_RXREADY_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -285,7 +318,7 @@ void nrf_radio_signal_MHRMATCH(){
   nrf_ppi_event(RADIO_EVENTS_MHRMATCH);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_MHRMATCH_Msk ){
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -294,7 +327,7 @@ void nrf_radio_signal_SYNC() {
   nrf_ppi_event(RADIO_EVENTS_SYNC);
 
   if (NRF_RADIO_INTEN & RADIO_INTENSET_SYNC_Msk) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -310,7 +343,7 @@ void nrf_radio_signal_PHYEND(){
   }
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_PHYEND_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
 
@@ -319,6 +352,6 @@ void nrf_radio_signal_CTEPRESENT(){
   nrf_ppi_event(RADIO_EVENTS_CTEPRESENT);
 
   if ( NRF_RADIO_INTEN & RADIO_INTENSET_CTEPRESENT_Msk ) {
-    hw_irq_ctrl_set_irq(RADIO_IRQn);
+    nrf_radio_raise_int_line();
   }
 }
@@ -12,6 +12,7 @@
 extern "C"{
 #endif
 
+void nrf_radio_eval_interrupt(void);
 void nrf_radio_signal_READY();
 void nrf_radio_signal_ADDRESS();
 void nrf_radio_signal_PAYLOAD();
@@ -12,8 +12,9 @@
 #include "bs_tracing.h"
 #include "NRF_RADIO.h"
 #include "NRF_RADIO_utils.h"
+#include "NRF_HW_ctx.h"
 
-static struct {
+static NRF_HW_STATE struct {
   /*Ramp up times*/
   bs_time_t TX_RU_time[3][2][2];
   /* The versions are [1,2Mbps, 15.4] [Normal, Fast] [No_TIFS, HW_TIFS] */
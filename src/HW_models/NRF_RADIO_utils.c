@@ -16,6 +16,7 @@
 #include "NRF_HWLowL.h"
 #include "time_machine_if.h"
 #include "NRF_RADIO_timings.h"
+#include "NRF_RADIO_utils.h"
 
 static void nrfra_check_crc_conf_ble(void) {
   if ( (NRF_RADIO_regs.CRCCNF & RADIO_CRCCNF_LEN_Msk)
@@ -474,10 +475,14 @@ uint32_t nrfra_get_rx_crc_value(uint8_t *rx_buf, size_t rx_packet_size) {
 }
 
 /**
- * Assemble a packet to be transmitted out thru the air into tx_buf[]
- * Omitting the preamble and address/sync flag
+ * Describe the packet to be transmitted out thru the air
+ * (omitting the preamble and address/sync flag) as 2 segments which point
+ * directly to the packet in RAM (PACKETPTR), without copying it:
+ *   segs[0]: The header (S0 + length)
+ *   segs[1]: S1 + the payload (skipping the S1 byte in RAM if it is not sent)
+ * Both segments are marked as covered by the CRC.
  *
- * Return copied payload size (after S0 + len + S1) into tx_buf[]
+ * Return the payload size (after S0 + len + S1)
  * (without the CRC)
  *
  * Note: PCNF1.MAXLEN is taken into account to cap len
@@ -486,10 +491,10 @@ uint32_t nrfra_get_rx_crc_value(uint8_t *rx_buf, size_t rx_packet_size) {
  * this needs to be reworked together with the start_Tx()
  * function, as it is all way too interdependent
  */
-uint nrfra_tx_copy_payload(uint8_t *tx_buf){
+uint nrfra_tx_packet_segments(crc_seg_t segs[2]){
   int S0Len, S1LenB, LFLenB; //All in bytes
   int LFLenb, S1LenAirb;
-  int i;
+  uint8_t *packet = (uint8_t*)NRF_RADIO_regs.PACKETPTR;
   uint payload_len;
   int maxlen;
 
@@ -502,16 +507,11 @@ uint nrfra_tx_copy_payload(uint8_t *tx_buf){
   LFLenb = (NRF_RADIO_regs.PCNF0 & RADIO_PCNF0_LFLEN_Msk) >> RADIO_PCNF0_LFLEN_Pos;
   LFLenB = (LFLenb + 7)/8;
 
-  //copy from RAM to Tx buffer
-  i = 0;
-  if (S0Len) {
-    tx_buf[0] = ((uint8_t*)NRF_RADIO_regs.PACKETPTR)[0];
-    i++;
-  }
-  for (int j = 0; j < LFLenB; j++){ //Copy up to 2 Length bytes
-    tx_buf[i] = ((uint8_t*)NRF_RADIO_regs.PACKETPTR)[i];
-    i++;
-  }
+  //S0 & up to 2 Length bytes
+  segs[0].data = packet;
+  segs[0].len = (S0Len ? 1 : 0) + LFLenB;
+  segs[0].crc = true;
+
   int S1Off = 0;
   if ( NRF_RADIO_regs.PCNF0 & ( RADIO_PCNF0_S1INCL_Include << RADIO_PCNF0_S1INCL_Pos ) ) {
     if (S1LenB == 0) {
@@ -524,7 +524,7 @@ uint nrfra_tx_copy_payload(uint8_t *tx_buf){
      */
   }
 
-  payload_len = nrfra_get_payload_length(tx_buf);
+  payload_len = nrfra_get_payload_length(packet);
   /* Note that we assume if CRCINC=1, CRCLEN is deducted from the length field
    * before capping the length to MAXLEN */
   maxlen = nrfra_get_MAXLEN();
@@ -540,7 +540,8 @@ uint nrfra_tx_copy_payload(uint8_t *tx_buf){
     NRF_RADIO_regs.PDUSTAT = 0;
   }
 
-  int copy_len = payload_len + S1LenB;
-  memcpy(&tx_buf[i], &((uint8_t*)NRF_RADIO_regs.PACKETPTR)[i + S1Off], copy_len);
+  segs[1].data = &packet[segs[0].len + S1Off];
+  segs[1].len = payload_len + S1LenB;
+  segs[1].crc = true;
   return payload_len;
 }
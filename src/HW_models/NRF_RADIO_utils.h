@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include "bs_pc_2G4_types.h"
+#include "crc.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -23,7 +24,7 @@ void nrfra_prep_rx_request(p2G4_rxv2_t *ongoing_rx, p2G4_address_t *rx_addresses
 void nrfra_prep_tx_request(p2G4_txv2_t *ongoing_tx, uint packet_size, bs_time_t packet_duration);
 void nrfra_prep_cca_request(p2G4_cca_t *cca_req, bool CCA_not_ED);
 
-uint nrfra_tx_copy_payload(uint8_t *tx_buf);
+uint nrfra_tx_packet_segments(crc_seg_t segs[2]);
 uint nrfra_get_payload_length(uint8_t *buf);
 uint32_t nrfra_get_rx_crc_value(uint8_t *rx_buf, size_t rx_packet_size);
 uint nrfra_get_crc_length();
@@ -22,17 +22,21 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_rand_main.h"
+#include "NRF_HW_ctx.h"
 
-NRF_RNG_Type NRF_RNG_regs;
-bs_time_t Timer_RNG = TIME_NEVER; //Time when the next random number will be ready
+NRF_HW_STATE NRF_RNG_Type NRF_RNG_regs;
+NRF_HW_STATE bs_time_t Timer_RNG = TIME_NEVER; //Time when the next random number will be ready
+static NRF_HW_STATE nrf_hw_timer_handle_t RNG_timer;
 
-static bool RNG_hw_started = false;
-static bool RNG_INTEN = false; //interrupt enable
+static NRF_HW_STATE bool RNG_hw_started = false;
+static NRF_HW_STATE bool RNG_INTEN = false; //interrupt enable
 
 /**
  * Initialize the RNG model
  */
 void nrf_rng_init(){
+  RNG_timer = nrf_hw_timer_register("RNG timer", NRF_HW_TIMER_PRIO_RNG, nrf_rng_timer_triggered);
+
   memset(&NRF_RNG_regs, 0, sizeof(NRF_RNG_regs));
   RNG_hw_started = false;
   RNG_INTEN = false;
@@ -66,7 +70,7 @@ static void nrf_rng_schedule_next(bool first_time){
   }
   Timer_RNG = tm_get_hw_time() + delay;
 
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RNG_timer, Timer_RNG);
 }
 
 /**
@@ -87,7 +91,7 @@ void nrf_rng_task_start(){
 void nrf_rng_task_stop(){
   RNG_hw_started = false;
   Timer_RNG = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RNG_timer, Timer_RNG);
 }
 
 
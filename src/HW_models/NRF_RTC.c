@@ -32,7 +32,9 @@
 #include "NRF_HW_model_top.h"
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
+#include "NRF_HW_trace.h"
 #include "time_machine_if.h"
+#include "NRF_HW_ctx.h"
 
 #define N_RTC 3
 #define N_CC 4
@@ -42,22 +44,24 @@
 
 #define SUB_US_BITS 9 // Bits representing sub-microsecond units
 
-NRF_RTC_Type NRF_RTC_regs[N_RTC];
+NRF_HW_STATE NRF_RTC_Type NRF_RTC_regs[N_RTC];
 
-static bool RTC_Running[N_RTC] = {false};
-static uint32_t RTC_INTEN[N_RTC] = {0};
+static NRF_HW_STATE bool RTC_Running[N_RTC] = {false};
+static NRF_HW_STATE uint32_t RTC_INTEN[N_RTC] = {0};
+static NRF_HW_STATE bool RTC_int_line[N_RTC] = {false}; //Is the RTC currently driving its interrupt line high
 
-bs_time_t Timer_RTC = TIME_NEVER;
-static bs_time_t cc_timers[N_RTC][N_CC] = {{TIME_NEVER}}; //when each CC will match (in microseconds)
-static bs_time_t overflow_timer[N_RTC] = {TIME_NEVER}; //when the timer will overflow (in microseconds)
+NRF_HW_STATE bs_time_t Timer_RTC = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t RTC_timer;
+static NRF_HW_STATE bs_time_t cc_timers[N_RTC][N_CC] = {{TIME_NEVER}}; //when each CC will match (in microseconds)
+static NRF_HW_STATE bs_time_t overflow_timer[N_RTC] = {TIME_NEVER}; //when the timer will overflow (in microseconds)
 
-static uint64_t overflow_timer_sub_us[N_RTC] = {TIME_NEVER}; //when the timer will overflow (in sub-microsecond units)
-static uint64_t RTC_counter_startT_sub_us[N_RTC] = {TIME_NEVER}; //Time when the counter was "started" (really the time that would correspond to COUNTER = 0)
-static uint64_t RTC_counter_startT_negative_sub_us[N_RTC] = {0};
+static NRF_HW_STATE uint64_t overflow_timer_sub_us[N_RTC] = {TIME_NEVER}; //when the timer will overflow (in sub-microsecond units)
+static NRF_HW_STATE uint64_t RTC_counter_startT_sub_us[N_RTC] = {TIME_NEVER}; //Time when the counter was "started" (really the time that would correspond to COUNTER = 0)
+static NRF_HW_STATE uint64_t RTC_counter_startT_negative_sub_us[N_RTC] = {0};
 
-static uint32_t counter[N_RTC] = {0}; //Internal counter value when the counter was stopped
+static NRF_HW_STATE uint32_t counter[N_RTC] = {0}; //Internal counter value when the counter was stopped
 
-static uint64_t first_lf_tick_time_sub_us = 0;
+static NRF_HW_STATE uint64_t first_lf_tick_time_sub_us = 0;
 
 
 static bs_time_t sub_us_time_to_us_time(uint64_t sub_us_time);
@@ -191,7 +195,7 @@ static void update_master_timer() {
       Timer_RTC = overflow_timer[rtc];
     }
   }
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(RTC_timer, Timer_RTC);
 }
 
 /**
@@ -306,6 +310,36 @@ static ppi_event_types_t get_overflow_event(int rtc)
     return event;
 }
 
+/*
+ * Evaluate the RTC interrupt line, and raise/lower it towards the NVIC if it changed
+ *
+ * As in other peripherals, INTEN bit n corresponds to the n-th EVENTS register
+ */
+static void nrf_rtc_eval_interrupt(int rtc)
+{
+  bool new_int_line = false;
+  volatile uint32_t *events = &NRF_RTC_regs[rtc].EVENTS_TICK;
+  uint32_t inten = RTC_INTEN[rtc];
+
+  while (inten) {
+    int n = __builtin_ctz(inten);
+    if (events[n]) {
+      new_int_line = true;
+      break; /* No need to check more */
+    }
+    inten &= inten - 1;
+  }
+
+  if (RTC_int_line[rtc] != new_int_line) {
+    hw_irq_ctrl_update_irq_lines(&RTC_int_line[rtc], new_int_line, get_irq_t(rtc));
+  }
+}
+
+static void nrf_rtc_irq_line_eval(unsigned int irq)
+{
+  nrf_rtc_eval_interrupt(irq == RTC0_IRQn ? 0 : 1);
+}
+
 static void handle_event(int rtc, ppi_event_types_t event, uint32_t mask)
 {
   NRF_RTC_Type *RTC_regs = &NRF_RTC_regs[rtc];
@@ -315,7 +349,7 @@ static void handle_event(int rtc, ppi_event_types_t event, uint32_t mask)
       nrf_ppi_event(event);
     }
     if ( RTC_INTEN[rtc] & mask ){
-      hw_irq_ctrl_set_irq(get_irq_t(rtc));
+      hw_irq_ctrl_update_irq_lines(&RTC_int_line[rtc], true, get_irq_t(rtc));
     }
   }
 }
@@ -329,7 +363,7 @@ static void handle_cc_event(int rtc, int cc)
   if ( cc_timers[rtc][cc] == Timer_RTC ){ //This CC is matching now
     update_cc_timer(rtc, cc); //Next time it will match
 
-    bs_trace_raw_time(8, "RTC%i: CC%i matching now\n", rtc, cc);
+    NRF_HW_TRACE_RAW_TIME(8, "RTC%i: CC%i matching now\n", rtc, cc);
 
     RTC_regs->EVENTS_COMPARE[cc] = 1;
     handle_event(rtc, event, mask);
@@ -350,7 +384,7 @@ static void handle_overflow_event(int rtc)
 
     update_overflow_timer(rtc); //Next time it will overflow
 
-    bs_trace_raw_time(8, "RTC%i: Timer overflow\n", rtc);
+    NRF_HW_TRACE_RAW_TIME(8, "RTC%i: Timer overflow\n", rtc);
 
     RTC_regs->EVENTS_OVRFLW = 1;
     handle_event(rtc, event, RTC_EVTEN_OVRFLW_Msk);
@@ -387,10 +421,13 @@ static void check_not_supported_func(uint32_t i) {
 }
 
 void nrf_rtc_init() {
+  RTC_timer = nrf_hw_timer_register("RTC timer", NRF_HW_TIMER_PRIO_RTC, nrf_rtc_timer_triggered);
+
   memset(NRF_RTC_regs, 0, sizeof(NRF_RTC_regs));
   for (int i = 0; i < N_RTC ; i++) {
     RTC_Running[i] = false;
     RTC_INTEN[i] = 0;
+    RTC_int_line[i] = false;
     counter[i] = 0;
     RTC_counter_startT_sub_us[i] = TIME_NEVER;
     RTC_counter_startT_negative_sub_us[i] = 0;
@@ -401,6 +438,9 @@ void nrf_rtc_init() {
     overflow_timer_sub_us[i] = TIME_NEVER;
   }
   Timer_RTC = TIME_NEVER;
+
+  hw_irq_ctrl_set_line_eval(RTC0_IRQn, nrf_rtc_irq_line_eval);
+  hw_irq_ctrl_set_line_eval(RTC1_IRQn, nrf_rtc_irq_line_eval);
 }
 
 void nrf_rtc_clean_up() {
@@ -409,7 +449,7 @@ void nrf_rtc_clean_up() {
 
 void nrf_rtc_notify_first_lf_tick() {
   first_lf_tick_time_sub_us = get_hw_time_sub_us();
-  bs_trace_raw_time(9, "RTC: First lf tick\n");
+  NRF_HW_TRACE_RAW_TIME(9, "RTC: First lf tick\n");
 }
 
 void nrf_rtc_update_COUNTER(int rtc) {
@@ -430,7 +470,7 @@ void nrf_rtc_TASKS_START(int rtc) {
   if (RTC_Running[rtc] == true) {
     return;
   }
-  bs_trace_raw_time(5, "RTC%i: TASK_START\n", rtc);
+  NRF_HW_TRACE_RAW_TIME(5, "RTC%i: TASK_START\n", rtc);
   RTC_Running[rtc] = true;
 
   //If the counter is not zero at start, is like if the counter was started earlier
@@ -444,7 +484,7 @@ void nrf_rtc_TASKS_STOP(int rtc) {
   if (RTC_Running[rtc] == false) {
     return;
   }
-  bs_trace_raw_time(5, "RTC%i: TASK_STOP\n", rtc);
+  NRF_HW_TRACE_RAW_TIME(5, "RTC%i: TASK_STOP\n", rtc);
   RTC_Running[rtc] = false;
   counter[rtc] = time_sub_us_to_counter(get_hw_time_sub_us() - RTC_counter_startT_sub_us[rtc]
                                         + RTC_counter_startT_negative_sub_us[rtc], rtc); //we save the value when the counter was stoped in case it is started again without clearing it
@@ -460,7 +500,7 @@ void nrf_rtc_TASKS_STOP(int rtc) {
  * TASK_CLEAR triggered handler
  */
 void nrf_rtc_TASKS_CLEAR(int rtc) {
-  bs_trace_raw_time(5, "RTC%i: TASK_CLEAR\n", rtc);
+  NRF_HW_TRACE_RAW_TIME(5, "RTC%i: TASK_CLEAR\n", rtc);
 
   set_counter_to(0, rtc);
 }
@@ -470,7 +510,7 @@ void nrf_rtc_TASKS_CLEAR(int rtc) {
  */
 void nrf_rtc_TASKS_TRIGOVRFLW(int rtc) {
 
-  bs_trace_raw_time(5, "RTC%i: TASK_TRIGGER_OVERFLOW\n", rtc);
+  NRF_HW_TRACE_RAW_TIME(5, "RTC%i: TASK_TRIGGER_OVERFLOW\n", rtc);
 
   set_counter_to(RTC_TRIGGER_OVERFLOW_COUNTER_VALUE, rtc);
 }
@@ -523,17 +563,9 @@ void nrf_rtc_regw_sideeffect_TASKS_TRIGOVRFLW(int i) {
 void nrf_rtc_regw_sideeffect_INTENSET(int i) {
   NRF_RTC_Type *RTC_regs = &NRF_RTC_regs[i];
   if ( RTC_regs->INTENSET ){
-    uint32_t new_interrupts = RTC_regs->INTENSET & ~RTC_INTEN[i];
-    unsigned int irq_t = get_irq_t(i);
-    uint32_t mask = RTC_EVTEN_COMPARE0_Msk;
-
     RTC_INTEN[i] |= RTC_regs->INTENSET;
     RTC_regs->INTENSET = RTC_INTEN[i];
-    for ( int cc = 0 ; cc < N_CC ; cc++, mask <<=1) {
-      if (RTC_regs->EVENTS_COMPARE[cc] && (new_interrupts & mask)) {
-        hw_irq_ctrl_set_irq(irq_t);
-      }
-    }
+    nrf_rtc_eval_interrupt(i);
 
     check_not_supported_func(RTC_INTEN[i]);
   }
@@ -545,9 +577,14 @@ void nrf_rtc_regw_sideeffect_INTENCLR(int i) {
     RTC_INTEN[i]  &= ~RTC_regs->INTENCLR;
     RTC_regs->INTENSET = RTC_INTEN[i];
     RTC_regs->INTENCLR = 0;
+    nrf_rtc_eval_interrupt(i);
   }
 }
 
+void nrf_rtc_regw_sideeffect_EVENTS_all(int i) {
+  nrf_rtc_eval_interrupt(i);
+}
+
 void nrf_rtc_regw_sideeffect_EVTENSET(int i) {
   NRF_RTC_Type *RTC_regs = &NRF_RTC_regs[i];
   if ( RTC_regs->EVTENSET ){
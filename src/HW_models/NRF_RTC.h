@@ -24,6 +24,7 @@ void nrf_rtc_regw_sideeffect_TASKS_CLEAR(int i);
 void nrf_rtc_regw_sideeffect_TASKS_TRIGOVRFLW(int i);
 void nrf_rtc_regw_sideeffect_INTENSET(int i);
 void nrf_rtc_regw_sideeffect_INTENCLR(int i);
+void nrf_rtc_regw_sideeffect_EVENTS_all(int i);
 void nrf_rtc_regw_sideeffect_EVTENSET(int i);
 void nrf_rtc_regw_sideeffect_EVTENCLR(int i);
 void nrf_rtc_regw_sideeffects_CC(int rtc, int cc_n);
@@ -25,22 +25,26 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_rand_main.h"
+#include "NRF_HW_ctx.h"
 
-NRF_TEMP_Type NRF_TEMP_regs;
+NRF_HW_STATE NRF_TEMP_Type NRF_TEMP_regs;
 
-bs_time_t Timer_TEMP = TIME_NEVER; //Time when the next temperature measurement will be ready
+NRF_HW_STATE bs_time_t Timer_TEMP = TIME_NEVER; //Time when the next temperature measurement will be ready
+static NRF_HW_STATE nrf_hw_timer_handle_t TEMP_timer;
 
-static bool TEMP_hw_started = false;
-static bool TEMP_INTEN = false; //interrupt enable
+static NRF_HW_STATE bool TEMP_hw_started = false;
+static NRF_HW_STATE bool TEMP_INTEN = false; //interrupt enable
 #define T_TEMP 36 /* microseconds */
 #define TEMP_FBITS 2 /* fractional bits */
 
-static double temperature = 25.0; /* Actual temperature the device is at */
+static NRF_HW_STATE double temperature = 25.0; /* Actual temperature the device is at */
 
 /**
  * Initialize the TEMP model
  */
 void nrf_temp_init(){
+  TEMP_timer = nrf_hw_timer_register("TEMP timer", NRF_HW_TIMER_PRIO_TEMP, nrf_temp_timer_triggered);
+
   memset(&NRF_TEMP_regs, 0, sizeof(NRF_TEMP_regs));
   NRF_TEMP_regs.A0 = 0x00000326;
   NRF_TEMP_regs.A1 = 0x00000348;
@@ -81,7 +85,7 @@ void nrf_temp_task_start(){
   }
   TEMP_hw_started = true;
   Timer_TEMP = tm_get_hw_time() + T_TEMP;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(TEMP_timer, Timer_TEMP);
 }
 
 /**
@@ -90,7 +94,7 @@ void nrf_temp_task_start(){
 void nrf_temp_task_stop(){
   TEMP_hw_started = false;
   Timer_TEMP = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(TEMP_timer, Timer_TEMP);
 }
 
 void nrf_temp_regw_sideeffects_TASK_START(){
@@ -142,7 +146,7 @@ void nrf_temp_timer_triggered(){
 
   TEMP_hw_started = false;
   Timer_TEMP = TIME_NEVER;
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(TEMP_timer, Timer_TEMP);
 
   NRF_TEMP_regs.EVENTS_DATARDY = 1;
   nrf_ppi_event(TEMP_EVENTS_DATARDY);
@@ -34,30 +34,36 @@
 #include "NRF_PPI.h"
 #include "irq_ctrl.h"
 #include "bs_tracing.h"
+#include "NRF_HW_ctx.h"
 
 #define N_TIMERS 5
 #define N_MAX_CC 6
-#define N_TIMER_CC_REGS {4, 4, 4, 6, 6} /* Number CC registers for each Timer */
+#define TIMER_CC_COUNT(t, cc) + 1
+#define TIMER_N_CCS(t) (0 NRF_TIMER_FOR_EACH_CC(TIMER_CC_COUNT, t)),
+#define N_TIMER_CC_REGS { NRF_TIMER_FOR_EACH_INST(TIMER_N_CCS) } /* Number CC registers for each Timer */
 
-NRF_TIMER_Type NRF_TIMER_regs[N_TIMERS];
+NRF_HW_STATE NRF_TIMER_Type NRF_TIMER_regs[N_TIMERS];
 
-static uint32_t TIMER_INTEN[N_TIMERS] = {0};
+static NRF_HW_STATE uint32_t TIMER_INTEN[N_TIMERS] = {0};
 
-static bool Timer_running[N_TIMERS] = {false};
+static NRF_HW_STATE bool Timer_running[N_TIMERS] = {false};
 
-static int Timer_n_CCs[N_TIMERS] = N_TIMER_CC_REGS;
+static NRF_HW_STATE int Timer_n_CCs[N_TIMERS] = N_TIMER_CC_REGS;
 
-static bs_time_t Timer_counter_startT[N_TIMERS] = {TIME_NEVER}; //Time when the timer was started (only for timer mode)
-static uint32_t Counter[N_TIMERS] = {0}; //Internal count value. Used in count mode, and in Timer mode during stops.
+static NRF_HW_STATE bs_time_t Timer_counter_startT[N_TIMERS] = {TIME_NEVER}; //Time when the timer was started (only for timer mode)
+static NRF_HW_STATE uint32_t Counter[N_TIMERS] = {0}; //Internal count value. Used in count mode, and in Timer mode during stops.
 
-bs_time_t Timer_TIMERs = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_TIMERs = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t TIMER_timer;
 /* In timer mode: When each compare match is expected to happen: */
-static bs_time_t CC_timers[N_TIMERS][N_MAX_CC] = {{TIME_NEVER}};
+static NRF_HW_STATE bs_time_t CC_timers[N_TIMERS][N_MAX_CC] = {{TIME_NEVER}};
 
 /**
  * Initialize the TIMER model
  */
 void nrf_hw_model_timer_init(void) {
+  TIMER_timer = nrf_hw_timer_register("TIMERx timer", NRF_HW_TIMER_PRIO_TIMER, nrf_hw_model_timer_timer_triggered);
+
   memset(NRF_TIMER_regs, 0, sizeof(NRF_TIMER_regs));
   for (int t = 0; t < N_TIMERS ; t++ ){
     TIMER_INTEN[t] = 0;
@@ -140,7 +146,7 @@ static void update_master_timer(void) {
       }
     }
   }
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(TIMER_timer, Timer_TIMERs);
 }
 
 /**
@@ -193,7 +199,7 @@ static int nrf_timer_get_irq_number(int t){
 }
 
 static void nrf_timer_eval_interrupts(int t) {
-  static bool TIMER_int_line[N_TIMERS]; /* Is the TIMER currently driving its interrupt line high */
+  static NRF_HW_STATE bool TIMER_int_line[N_TIMERS]; /* Is the TIMER currently driving its interrupt line high */
   bool new_int_line = false;
   int irq_line = nrf_timer_get_irq_number(t);
   const char *no_int_error = "NRF HW TIMER%i interrupt triggered "
@@ -207,19 +213,10 @@ static void nrf_timer_eval_interrupts(int t) {
     }
   }
 
-  if (TIMER_int_line[t] == false && new_int_line == true) {
-    TIMER_int_line[t] = true;
-    if (irq_line < -1) {
-      bs_trace_error_line_time(no_int_error, t);
-    }
-    hw_irq_ctrl_raise_level_irq_line(irq_line);
-  } else if (TIMER_int_line[t] == true && new_int_line == false) {
-    TIMER_int_line[t] = false;
-    if (irq_line < -1) {
-      bs_trace_error_line_time(no_int_error, t);
-    }
-    hw_irq_ctrl_lower_level_irq_line(irq_line);
+  if ((TIMER_int_line[t] != new_int_line) && (irq_line < -1)) {
+    bs_trace_error_line_time(no_int_error, t);
   }
+  hw_irq_ctrl_update_irq_lines(&TIMER_int_line[t], new_int_line, irq_line);
 }
 
 void nrf_timer_TASK_START(int t){
@@ -453,56 +450,3 @@ void nrf_hw_model_timer_timer_triggered(void) {
   }
   update_master_timer();
 }
-
-void nrf_timer0_TASK_START() { nrf_timer_TASK_START(0); }
-void nrf_timer1_TASK_START() { nrf_timer_TASK_START(1); }
-void nrf_timer2_TASK_START() { nrf_timer_TASK_START(2); }
-void nrf_timer3_TASK_START() { nrf_timer_TASK_START(3); }
-void nrf_timer4_TASK_START() { nrf_timer_TASK_START(4); }
-
-void nrf_timer0_TASK_STOP(void) { nrf_timer_TASK_STOP(0); }
-void nrf_timer1_TASK_STOP(void) { nrf_timer_TASK_STOP(1); }
-void nrf_timer2_TASK_STOP(void) { nrf_timer_TASK_STOP(2); }
-void nrf_timer3_TASK_STOP(void) { nrf_timer_TASK_STOP(3); }
-void nrf_timer4_TASK_STOP(void) { nrf_timer_TASK_STOP(4); }
-
-void nrf_timer0_TASK_CAPTURE_0(void) { nrf_timer_TASK_CAPTURE(0,0); }
-void nrf_timer0_TASK_CAPTURE_1(void) { nrf_timer_TASK_CAPTURE(0,1); }
-void nrf_timer0_TASK_CAPTURE_2(void) { nrf_timer_TASK_CAPTURE(0,2); }
-void nrf_timer0_TASK_CAPTURE_3(void) { nrf_timer_TASK_CAPTURE(0,3); }
-
-void nrf_timer1_TASK_CAPTURE_0(void) { nrf_timer_TASK_CAPTURE(1,0); }
-void nrf_timer1_TASK_CAPTURE_1(void) { nrf_timer_TASK_CAPTURE(1,1); }
-void nrf_timer1_TASK_CAPTURE_2(void) { nrf_timer_TASK_CAPTURE(1,2); }
-void nrf_timer1_TASK_CAPTURE_3(void) { nrf_timer_TASK_CAPTURE(1,3); }
-
-void nrf_timer2_TASK_CAPTURE_0(void) { nrf_timer_TASK_CAPTURE(2,0); }
-void nrf_timer2_TASK_CAPTURE_1(void) { nrf_timer_TASK_CAPTURE(2,1); }
-void nrf_timer2_TASK_CAPTURE_2(void) { nrf_timer_TASK_CAPTURE(2,2); }
-void nrf_timer2_TASK_CAPTURE_3(void) { nrf_timer_TASK_CAPTURE(2,3); }
-
-void nrf_timer3_TASK_CAPTURE_0(void) { nrf_timer_TASK_CAPTURE(3,0); }
-void nrf_timer3_TASK_CAPTURE_1(void) { nrf_timer_TASK_CAPTURE(3,1); }
-void nrf_timer3_TASK_CAPTURE_2(void) { nrf_timer_TASK_CAPTURE(3,2); }
-void nrf_timer3_TASK_CAPTURE_3(void) { nrf_timer_TASK_CAPTURE(3,3); }
-void nrf_timer3_TASK_CAPTURE_4(void) { nrf_timer_TASK_CAPTURE(3,4); }
-void nrf_timer3_TASK_CAPTURE_5(void) { nrf_timer_TASK_CAPTURE(3,5); }
-
-void nrf_timer4_TASK_CAPTURE_0(void) { nrf_timer_TASK_CAPTURE(4,0); }
-void nrf_timer4_TASK_CAPTURE_1(void) { nrf_timer_TASK_CAPTURE(4,1); }
-void nrf_timer4_TASK_CAPTURE_2(void) { nrf_timer_TASK_CAPTURE(4,2); }
-void nrf_timer4_TASK_CAPTURE_3(void) { nrf_timer_TASK_CAPTURE(4,3); }
-void nrf_timer4_TASK_CAPTURE_4(void) { nrf_timer_TASK_CAPTURE(4,4); }
-void nrf_timer4_TASK_CAPTURE_5(void) { nrf_timer_TASK_CAPTURE(4,5); }
-
-void nrf_timer0_TASK_CLEAR(void) { nrf_timer_TASK_CLEAR(0); }
-void nrf_timer1_TASK_CLEAR(void) { nrf_timer_TASK_CLEAR(1); }
-void nrf_timer2_TASK_CLEAR(void) { nrf_timer_TASK_CLEAR(2); }
-void nrf_timer3_TASK_CLEAR(void) { nrf_timer_TASK_CLEAR(3); }
-void nrf_timer4_TASK_CLEAR(void) { nrf_timer_TASK_CLEAR(4); }
-
-void nrf_timer0_TASK_COUNT(void) { nrf_timer_TASK_COUNT(0); }
-void nrf_timer1_TASK_COUNT(void) { nrf_timer_TASK_COUNT(1); }
-void nrf_timer2_TASK_COUNT(void) { nrf_timer_TASK_COUNT(2); }
-void nrf_timer3_TASK_COUNT(void) { nrf_timer_TASK_COUNT(3); }
-void nrf_timer4_TASK_COUNT(void) { nrf_timer_TASK_COUNT(4); }
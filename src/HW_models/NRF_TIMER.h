@@ -19,58 +19,30 @@ void nrf_hw_model_timer_timer_triggered(void);
 
 extern NRF_TIMER_Type NRF_TIMER_regs[];
 
-void nrf_timer0_TASK_CAPTURE_0(void);
-void nrf_timer0_TASK_CAPTURE_1(void);
-void nrf_timer0_TASK_CAPTURE_2(void);
-void nrf_timer0_TASK_CAPTURE_3(void);
-
-void nrf_timer1_TASK_CAPTURE_0(void);
-void nrf_timer1_TASK_CAPTURE_1(void);
-void nrf_timer1_TASK_CAPTURE_2(void);
-void nrf_timer1_TASK_CAPTURE_3(void);
-
-void nrf_timer2_TASK_CAPTURE_0(void);
-void nrf_timer2_TASK_CAPTURE_1(void);
-void nrf_timer2_TASK_CAPTURE_2(void);
-void nrf_timer2_TASK_CAPTURE_3(void);
-
-void nrf_timer3_TASK_CAPTURE_0(void);
-void nrf_timer3_TASK_CAPTURE_1(void);
-void nrf_timer3_TASK_CAPTURE_2(void);
-void nrf_timer3_TASK_CAPTURE_3(void);
-void nrf_timer3_TASK_CAPTURE_4(void);
-void nrf_timer3_TASK_CAPTURE_5(void);
-
-void nrf_timer4_TASK_CAPTURE_0(void);
-void nrf_timer4_TASK_CAPTURE_1(void);
-void nrf_timer4_TASK_CAPTURE_2(void);
-void nrf_timer4_TASK_CAPTURE_3(void);
-void nrf_timer4_TASK_CAPTURE_4(void);
-void nrf_timer4_TASK_CAPTURE_5(void);
-
-void nrf_timer0_TASK_CLEAR(void);
-void nrf_timer1_TASK_CLEAR(void);
-void nrf_timer2_TASK_CLEAR(void);
-void nrf_timer3_TASK_CLEAR(void);
-void nrf_timer4_TASK_CLEAR(void);
-
-void nrf_timer0_TASK_COUNT(void);
-void nrf_timer1_TASK_COUNT(void);
-void nrf_timer2_TASK_COUNT(void);
-void nrf_timer3_TASK_COUNT(void);
-void nrf_timer4_TASK_COUNT(void);
-
-void nrf_timer0_TASK_START(void);
-void nrf_timer1_TASK_START(void);
-void nrf_timer2_TASK_START(void);
-void nrf_timer3_TASK_START(void);
-void nrf_timer4_TASK_START(void);
-
-void nrf_timer0_TASK_STOP(void);
-void nrf_timer1_TASK_STOP(void);
-void nrf_timer2_TASK_STOP(void);
-void nrf_timer3_TASK_STOP(void);
-void nrf_timer4_TASK_STOP(void);
+/*
+ * Description of the TIMER instances, from which the PPI tasks and
+ * events tables, the TIMER ppi_event_types_t, and the TIMER model number of
+ * CC registers are generated:
+ *  NRF_TIMER_FOR_EACH_INST(X) expands to X(t) for each TIMER instance <t>
+ *  NRF_TIMER_FOR_EACH_CC(X, t) expands to X(t, cc) for each of the CC registers
+ *  (and TASKS_CAPTURE[cc] & EVENTS_COMPARE[cc]) of TIMER <t>
+ */
+#define NRF_TIMER_FOR_EACH_INST(X) X(0) X(1) X(2) X(3) X(4)
+
+#define NRF_TIMER_FOR_EACH_CC(X, t) NRF_TIMER_CCS_##t(X, t)
+#define NRF_TIMER_CCS_0(X, t) NRF_TIMER_4_CCS(X, t)
+#define NRF_TIMER_CCS_1(X, t) NRF_TIMER_4_CCS(X, t)
+#define NRF_TIMER_CCS_2(X, t) NRF_TIMER_4_CCS(X, t)
+#define NRF_TIMER_CCS_3(X, t) NRF_TIMER_6_CCS(X, t)
+#define NRF_TIMER_CCS_4(X, t) NRF_TIMER_6_CCS(X, t)
+#define NRF_TIMER_4_CCS(X, t) X(t, 0) X(t, 1) X(t, 2) X(t, 3)
+#define NRF_TIMER_6_CCS(X, t) NRF_TIMER_4_CCS(X, t) X(t, 4) X(t, 5)
+
+void nrf_timer_TASK_START(int t);
+void nrf_timer_TASK_STOP(int t);
+void nrf_timer_TASK_CLEAR(int t);
+void nrf_timer_TASK_COUNT(int t);
+void nrf_timer_TASK_CAPTURE(int t, int cc_n);
 
 void nrf_timer_regw_sideeffects_TASKS_STOP(int t);
 void nrf_timer_regw_sideeffects_TASKS_SHUTDOWN(int t);
@@ -13,6 +13,14 @@ static nrf_hw_sub_args_t *args_g_hw;
 
 void nrf_hw_sub_cmline_set_defaults(nrf_hw_sub_args_t *args){
   args->useRealAES = 0;
+  args->batch_dispatch = false;
+  args->profile = false;
+  args->profile_period = 10;
+  args->ppi_stats = false;
+  args->fanout_n = 0;
+  args->fanout_time = 0;
+  args->fanout_reseed = false;
+  args->fanout_gpio_in_file = NULL;
   args_g_hw = args;
 }
 
@@ -35,3 +43,44 @@ bool nrfhw_useRealAES;
 void nrf_hw_cmd_useRealAES_found(char * argv, int offset){
   args_g_hw->useRealAES = nrfhw_useRealAES;
 }
+
+bool nrfhw_batch_dispatch;
+void nrf_hw_cmd_batch_dispatch_found(char * argv, int offset){
+  args_g_hw->batch_dispatch = nrfhw_batch_dispatch;
+}
+
+bool nrfhw_profile;
+void nrf_hw_cmd_profile_found(char * argv, int offset){
+  args_g_hw->profile = nrfhw_profile;
+}
+
+double nrfhw_profile_period;
+void nrf_hw_cmd_profile_period_found(char * argv, int offset){
+  args_g_hw->profile_period = nrfhw_profile_period;
+}
+
+bool nrfhw_ppi_stats;
+void nrf_hw_cmd_ppi_stats_found(char * argv, int offset){
+  args_g_hw->ppi_stats = nrfhw_ppi_stats;
+}
+
+unsigned int nrfhw_fanout_n;
+void nrf_hw_cmd_fanout_n_found(char * argv, int offset){
+  args_g_hw->fanout_n = nrfhw_fanout_n;
+}
+
+double nrfhw_fanout_time;
+void nrf_hw_cmd_fanout_time_found(char * argv, int offset){
+  args_g_hw->fanout_time = nrfhw_fanout_time;
+}
+
+unsigned int nrfhw_fanout_seed;
+void nrf_hw_cmd_fanout_seed_found(char * argv, int offset){
+  args_g_hw->fanout_reseed = true;
+  args_g_hw->fanout_seed = nrfhw_fanout_seed;
+}
+
+char *nrfhw_fanout_gpio_in_file;
+void nrf_hw_cmd_fanout_gpio_in_file_found(char * argv, int offset){
+  args_g_hw->fanout_gpio_in_file = nrfhw_fanout_gpio_in_file;
+}
@@ -16,6 +16,15 @@ typedef struct {
   double xo_drift;
   double start_offset;
   bool useRealAES;
+  bool batch_dispatch;
+  bool profile;
+  double profile_period;
+  bool ppi_stats;
+  unsigned int fanout_n;
+  double fanout_time;
+  bool fanout_reseed;
+  unsigned int fanout_seed;
+  char *fanout_gpio_in_file;
 } nrf_hw_sub_args_t;
 
 void nrf_hw_sub_cmline_set_defaults(nrf_hw_sub_args_t *ptr);
@@ -28,6 +37,22 @@ extern double nrfhw_drift;
 void nrf_hw_cmd_drift_found(char * argv, int offset);
 extern bool nrfhw_useRealAES;
 void nrf_hw_cmd_useRealAES_found(char * argv, int offset);
+extern bool nrfhw_batch_dispatch;
+void nrf_hw_cmd_batch_dispatch_found(char * argv, int offset);
+extern bool nrfhw_profile;
+void nrf_hw_cmd_profile_found(char * argv, int offset);
+extern double nrfhw_profile_period;
+void nrf_hw_cmd_profile_period_found(char * argv, int offset);
+extern bool nrfhw_ppi_stats;
+void nrf_hw_cmd_ppi_stats_found(char * argv, int offset);
+extern unsigned int nrfhw_fanout_n;
+void nrf_hw_cmd_fanout_n_found(char * argv, int offset);
+extern double nrfhw_fanout_time;
+void nrf_hw_cmd_fanout_time_found(char * argv, int offset);
+extern unsigned int nrfhw_fanout_seed;
+void nrf_hw_cmd_fanout_seed_found(char * argv, int offset);
+extern char *nrfhw_fanout_gpio_in_file;
+void nrf_hw_cmd_fanout_gpio_in_file_found(char * argv, int offset);
 extern char *gpio_in_file_path;
 extern char *gpio_out_file_path;
 extern char *gpio_conf_file_path;
@@ -37,6 +62,14 @@ extern char *gpio_conf_file_path;
   { false  , false , false, "start_offset" ,  "start_of", 'f', (void*)&nrfhw_start_of, nrf_hw_cmd_starto_found,"Offset in time (at the start of the simulation) of this device. At time 0 of the device, the phy will be at <start_of>"}, \
   { false  , false , false, "xo_drift" ,      "xo_drift", 'f', (void*)&nrfhw_drift,    nrf_hw_cmd_drift_found, "Simple linear model of the XO drift of this device. For ex. for -30ppm set to -30e-6"}, \
   { false  , false , false, "RealEncryption", "realAES",  'b', (void*)&nrfhw_useRealAES, nrf_hw_cmd_useRealAES_found, "(0)/1 Use the real AES encryption for the LL or just send everything in plain text (default) (requires the ext_libCryptov1 component)"}, \
+  { false  , false , true,  "hw_batch_dispatch", "",    'b', (void*)&nrfhw_batch_dispatch, nrf_hw_cmd_batch_dispatch_found, "Run all HW models events due at the same time in one go, instead of one per time machine delta cycle"}, \
+  { false  , false , true,  "hw_profile",     "",         'b', (void*)&nrfhw_profile,  nrf_hw_cmd_profile_found, "Profile the HW models events: dispatch count, host time spent, and simulated time between events per HW timer, and the real time factor"}, \
+  { false  , false , false, "hw_profile_period", "period", 'f', (void*)&nrfhw_profile_period, nrf_hw_cmd_profile_period_found, "With -hw_profile, dump the profiling report every <period> simulated seconds (default 10), 0 to only dump it at exit"}, \
+  { false  , false , true,  "hw_ppi_stats",   "",         'b', (void*)&nrfhw_ppi_stats, nrf_hw_cmd_ppi_stats_found, "Count how many times each PPI event, channel and task is used, and dump them with the PPI routing at exit"}, \
+  { false  , false , false, "hw_fanout_n",    "n",        'u', (void*)&nrfhw_fanout_n, nrf_hw_cmd_fanout_n_found, "Fork <n> children at -hw_fanout_time, each continuing the simulation from that point with its own stimulus (requires -nosim)"}, \
+  { false  , false , false, "hw_fanout_time", "time",     'f', (void*)&nrfhw_fanout_time, nrf_hw_cmd_fanout_time_found, "Simulated time (in microseconds) at which to fork the -hw_fanout_n children (default 0)"}, \
+  { false  , false , false, "hw_fanout_seed", "seed",     'u', (void*)&nrfhw_fanout_seed, nrf_hw_cmd_fanout_seed_found, "With -hw_fanout_n, reseed the random generator of each child with <seed> + <child number>"}, \
+  { false  , false , false, "hw_fanout_gpio_in_file", "path", 's', (void*)&nrfhw_fanout_gpio_in_file, nrf_hw_cmd_fanout_gpio_in_file_found, "With -hw_fanout_n, GPIO input file for each child, where %i is replaced by the child number (lines before the fork time are skipped)"}, \
   { \
     .option="gpio_in_file",\
     .name="path",\
@@ -12,12 +12,25 @@
 #include "time_machine_if.h"
 #include "irq_ctrl.h"
 #include "NRF_HW_model_top.h"
+#include "bstest_ticker.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_event_fw_test_ticker = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_event_fw_test_ticker = TIME_NEVER;
 
-static uint8_t awake_cpu_asap = 0;
-static bs_time_t Timer_event_fw_test_ticker_internal = TIME_NEVER;
-static bs_time_t fw_test_ticker_tick_period = TIME_NEVER;
+static NRF_HW_STATE uint8_t awake_cpu_asap = 0;
+static NRF_HW_STATE bs_time_t Timer_event_fw_test_ticker_internal = TIME_NEVER;
+static NRF_HW_STATE bs_time_t fw_test_ticker_tick_period = TIME_NEVER;
+
+static NRF_HW_STATE nrf_hw_timer_handle_t fw_test_ticker;
+
+static void bst_ticker_timer_triggered(void){
+  bst_ticker_triggered(timer_nrf_main_timer);
+}
+
+void bst_ticker_init(void){
+  fw_test_ticker = nrf_hw_timer_register("FW test ticker", NRF_HW_TIMER_PRIO_FW_TEST_TICKER,
+                                         bst_ticker_timer_triggered);
+}
 
 static void bst_ticker_find_next_time(){
   if ( awake_cpu_asap == 1){
@@ -26,7 +39,7 @@ static void bst_ticker_find_next_time(){
     Timer_event_fw_test_ticker = Timer_event_fw_test_ticker_internal;
   }
 
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(fw_test_ticker, Timer_event_fw_test_ticker);
 }
 
 /**
@@ -13,6 +13,8 @@
 extern "C"{
 #endif
 
+void bst_ticker_init(void);
+
 //Interface towards the time_machine:
 void bst_ticker_triggered(bs_time_t Now);
 
@@ -7,169 +7,417 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CRC_HAVE_CLMUL 1
+#include <cpuid.h>
+#include <immintrin.h>
+#else
+#define CRC_HAVE_CLMUL 0
+#endif
+
+/*
+ * Generic (reflected, i.e. LSB first) CRC engine, for CRCs of 1 to 3 bytes
+ * like the nRF RADIO's.
+ *
+ * The CRC is calculated with the slicing-by-8 algorithm, with tables generated
+ * for the configured polynomial on first use.
+ * The BLE and 802.15.4 CRCs have their own dedicated engines, while the tables
+ * for any other configuration are kept in a small cache.
+ *
+ * In x86 hosts whose CPU supports the carry-less multiplication instruction
+ * (PCLMULQDQ), buffers of CRC_CLMUL_MIN_LEN bytes or more are instead processed
+ * 16 bytes at a time by folding (see crc_update_clmul()), with the tables only
+ * used for the remaining bytes.
+ */
 
 /**
- * Bitwise reverse 1 byte,
+ * Table to bitwise reverse 1 byte,
  * Based on code in the public domain as claimed by the author in this page:
- * http://graphics.stanford.edu/~seander/bithacks.html#ReverseByteWith64Bits
+ * http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
  */
-static uint8_t rev_byte(uint8_t input){
-  return ((input * 0x80200802ULL) & 0x0884422110ULL)
-          * 0x0101010101ULL >> 32;
-}
+#define R2(n)    n,     n + 2*64,     n + 1*64,     n + 3*64
+#define R4(n) R2(n), R2(n + 2*16), R2(n + 1*16), R2(n + 3*16)
+#define R6(n) R4(n), R4(n + 2*4 ), R4(n + 1*4 ), R4(n + 3*4 )
+static const uint8_t rev_byte_table[256] = {
+    R6(0), R6(2), R6(1), R6(3)
+};
+#undef R2
+#undef R4
+#undef R6
 
 /**
- * Reverse the bits order in a 24 bit word
+ * Reverse the bits order in a word of <n_bytes> bytes (1 to 4)
  */
-static uint32_t rev_24(uint32_t input){
-  uint32_t ret;
-  ret = rev_byte((input >> 0) & 0xff) << 16
-      | rev_byte((input >> 8) & 0xff) << 8
-      | rev_byte((input >> 16) & 0xff);
+static uint32_t rev_bits(uint32_t input, unsigned int n_bytes){
+  uint32_t ret = 0;
+  for (unsigned int i = 0; i < n_bytes; i++) {
+    ret = (ret << 8) | rev_byte_table[(input >> (i*8)) & 0xff];
+  }
   return ret;
 }
 
+#define CRC_SLICES 8
+
+typedef struct {
+  unsigned int len;  /* CRC length in bytes, 0 if this engine was not yet built */
+  uint32_t poly;     /* Polynomial, as in CRCPOLY (without the x^(8*len) term) */
+  uint32_t table[CRC_SLICES][256];
+#if CRC_HAVE_CLMUL
+  uint64_t fold_k[8]; /* Folding and Barrett reduction constants for crc_update_clmul() */
+#endif
+} crc_engine_t;
+
+static crc_engine_t crc_engine_ble;
+static crc_engine_t crc_engine_154;
+
+#define CRC_CACHE_SIZE 4
+static crc_engine_t crc_engine_cache[CRC_CACHE_SIZE];
+static unsigned int crc_engine_cache_next;
+
+#if CRC_HAVE_CLMUL
 /**
- * Reverse the bits order in a 16 bit word
+ * Reverse the bits order in the <n_bits> (up to 64) LSBs of a word
  */
-static uint32_t rev_16(uint16_t input){
-  uint16_t ret;
-  ret = rev_byte((input >> 0) & 0xff) << 8
-      | rev_byte((input >> 8) & 0xff) << 0;
+static uint64_t rev_bits64(uint64_t input, unsigned int n_bits){
+  uint64_t ret = 0;
+  for (unsigned int i = 0; i < n_bits; i++) {
+    ret = (ret << 1) | ((input >> i) & 1);
+  }
   return ret;
 }
 
+/**
+ * x^n mod P(x), where P is a 32 degree polynomial (with bit 32 set)
+ */
+static uint64_t crc_xn_mod(uint64_t P, unsigned int n){
+  uint64_t rem = 1;
+  for (unsigned int i = 0; i < n; i++) {
+    rem <<= 1;
+    if (rem & ((uint64_t)1 << 32)) {
+      rem ^= P;
+    }
+  }
+  return rem;
+}
+
+/**
+ * Generate the constants for crc_update_clmul()
+ *
+ * A CRC of w bits with polynomial P(x), calculated LSB first, gives the same
+ * result as one of 32 bits with polynomial P(x)*x^(32-w).
+ * So we just calculate the constants for that 32 degree polynomial, and use
+ * the same folding algorithm as for a CRC32, as described in
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction",
+ * V. Gopal et al., Intel, 2009.
+ */
+static void crc_engine_build_clmul(crc_engine_t *engine, unsigned int len, uint32_t poly){
+  uint64_t P = ((uint64_t)1 << 32) | ((uint64_t)poly << (32 - 8*len));
+  uint64_t quot = (uint64_t)1 << 32;
+  uint64_t rem = (P & 0xFFFFFFFF) << 32;
+
+  /* floor(x^64 / P(x)) */
+  for (int j = 31; j >= 0; j--) {
+    if (rem & ((uint64_t)1 << (32 + j))) {
+      rem ^= P << j;
+      quot |= (uint64_t)1 << j;
+    }
+  }
+
+  engine->fold_k[0] = rev_bits64(crc_xn_mod(P, 4*128+32), 32) << 1;
+  engine->fold_k[1] = rev_bits64(crc_xn_mod(P, 4*128-32), 32) << 1;
+  engine->fold_k[2] = rev_bits64(crc_xn_mod(P, 128+32), 32) << 1;
+  engine->fold_k[3] = rev_bits64(crc_xn_mod(P, 128-32), 32) << 1;
+  engine->fold_k[4] = rev_bits64(crc_xn_mod(P, 64), 32) << 1;
+  engine->fold_k[5] = 0;
+  engine->fold_k[6] = rev_bits64(P, 33);
+  engine->fold_k[7] = rev_bits64(quot, 33);
+}
+#endif
+
+/**
+ * Generate the slicing-by-8 tables for a given CRC
+ *
+ * table[0] is the normal byte at a time table, table[k] is the CRC of
+ * a byte followed by k zero bytes
+ */
+static void crc_engine_build(crc_engine_t *engine, unsigned int len, uint32_t poly){
+  uint32_t rev_poly = rev_bits(poly, len);
+
+  for (unsigned int i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 1) ? (crc >> 1) ^ rev_poly : crc >> 1;
+    }
+    engine->table[0][i] = crc;
+  }
+  for (unsigned int i = 0; i < 256; i++) {
+    uint32_t crc = engine->table[0][i];
+    for (int k = 1; k < CRC_SLICES; k++) {
+      crc = engine->table[0][crc & 0xff] ^ (crc >> 8);
+      engine->table[k][i] = crc;
+    }
+  }
+#if CRC_HAVE_CLMUL
+  crc_engine_build_clmul(engine, len, poly);
+#endif
+  engine->poly = poly;
+  engine->len = len;
+}
+
+/**
+ * Find (or build) the engine for a CRC of <len> bytes and polynomial <poly>
+ */
+static const crc_engine_t *crc_engine_get(unsigned int len, uint32_t poly){
+  crc_engine_t *engine;
+
+  if ((len == 3) && (poly == 0x00065B)) {
+    engine = &crc_engine_ble;
+  } else if ((len == 2) && (poly == 0x1021)) {
+    engine = &crc_engine_154;
+  } else {
+    for (int i = 0; i < CRC_CACHE_SIZE; i++) {
+      engine = &crc_engine_cache[i];
+      if ((engine->len == len) && (engine->poly == poly)) {
+        return engine;
+      }
+    }
+    engine = &crc_engine_cache[crc_engine_cache_next];
+    crc_engine_cache_next = (crc_engine_cache_next + 1) % CRC_CACHE_SIZE;
+    engine->len = 0;
+  }
+
+  if (engine->len == 0) {
+    crc_engine_build(engine, len, poly);
+  }
+  return engine;
+}
+
+#if CRC_HAVE_CLMUL
 /*
- Table implementation of the CRCs autogenerated with these scripts (with very minor modifications)
- https://pycrc.org (These python scripts are MIT licensed)
- Options="--std=C99 --width=24 --poly=0x100065B --algorithm=table-driven --xor-out=0x0 --xor-in=0x555555 --reflect-in=true --reflect-out=true --crc-type=uint32_t"
- python pycrc.py $Options --generate=h > pycrc_stdout.h
- python pycrc.py $Options --generate=c-main  > pycrc_stdout.c
- gcc pycrc_stdout.c -o testexe && ./testexe -s "@"
+ * Below this length, the tables are as fast or faster
  */
-static const uint32_t crc_table_24_ble[256] = {
-    0x000000, 0x01b4c0, 0x036980, 0x02dd40, 0x06d300, 0x0767c0, 0x05ba80, 0x040e40,
-    0x0da600, 0x0c12c0, 0x0ecf80, 0x0f7b40, 0x0b7500, 0x0ac1c0, 0x081c80, 0x09a840,
-    0x1b4c00, 0x1af8c0, 0x182580, 0x199140, 0x1d9f00, 0x1c2bc0, 0x1ef680, 0x1f4240,
-    0x16ea00, 0x175ec0, 0x158380, 0x143740, 0x103900, 0x118dc0, 0x135080, 0x12e440,
-    0x369800, 0x372cc0, 0x35f180, 0x344540, 0x304b00, 0x31ffc0, 0x332280, 0x329640,
-    0x3b3e00, 0x3a8ac0, 0x385780, 0x39e340, 0x3ded00, 0x3c59c0, 0x3e8480, 0x3f3040,
-    0x2dd400, 0x2c60c0, 0x2ebd80, 0x2f0940, 0x2b0700, 0x2ab3c0, 0x286e80, 0x29da40,
-    0x207200, 0x21c6c0, 0x231b80, 0x22af40, 0x26a100, 0x2715c0, 0x25c880, 0x247c40,
-    0x6d3000, 0x6c84c0, 0x6e5980, 0x6fed40, 0x6be300, 0x6a57c0, 0x688a80, 0x693e40,
-    0x609600, 0x6122c0, 0x63ff80, 0x624b40, 0x664500, 0x67f1c0, 0x652c80, 0x649840,
-    0x767c00, 0x77c8c0, 0x751580, 0x74a140, 0x70af00, 0x711bc0, 0x73c680, 0x727240,
-    0x7bda00, 0x7a6ec0, 0x78b380, 0x790740, 0x7d0900, 0x7cbdc0, 0x7e6080, 0x7fd440,
-    0x5ba800, 0x5a1cc0, 0x58c180, 0x597540, 0x5d7b00, 0x5ccfc0, 0x5e1280, 0x5fa640,
-    0x560e00, 0x57bac0, 0x556780, 0x54d340, 0x50dd00, 0x5169c0, 0x53b480, 0x520040,
-    0x40e400, 0x4150c0, 0x438d80, 0x423940, 0x463700, 0x4783c0, 0x455e80, 0x44ea40,
-    0x4d4200, 0x4cf6c0, 0x4e2b80, 0x4f9f40, 0x4b9100, 0x4a25c0, 0x48f880, 0x494c40,
-    0xda6000, 0xdbd4c0, 0xd90980, 0xd8bd40, 0xdcb300, 0xdd07c0, 0xdfda80, 0xde6e40,
-    0xd7c600, 0xd672c0, 0xd4af80, 0xd51b40, 0xd11500, 0xd0a1c0, 0xd27c80, 0xd3c840,
-    0xc12c00, 0xc098c0, 0xc24580, 0xc3f140, 0xc7ff00, 0xc64bc0, 0xc49680, 0xc52240,
-    0xcc8a00, 0xcd3ec0, 0xcfe380, 0xce5740, 0xca5900, 0xcbedc0, 0xc93080, 0xc88440,
-    0xecf800, 0xed4cc0, 0xef9180, 0xee2540, 0xea2b00, 0xeb9fc0, 0xe94280, 0xe8f640,
-    0xe15e00, 0xe0eac0, 0xe23780, 0xe38340, 0xe78d00, 0xe639c0, 0xe4e480, 0xe55040,
-    0xf7b400, 0xf600c0, 0xf4dd80, 0xf56940, 0xf16700, 0xf0d3c0, 0xf20e80, 0xf3ba40,
-    0xfa1200, 0xfba6c0, 0xf97b80, 0xf8cf40, 0xfcc100, 0xfd75c0, 0xffa880, 0xfe1c40,
-    0xb75000, 0xb6e4c0, 0xb43980, 0xb58d40, 0xb18300, 0xb037c0, 0xb2ea80, 0xb35e40,
-    0xbaf600, 0xbb42c0, 0xb99f80, 0xb82b40, 0xbc2500, 0xbd91c0, 0xbf4c80, 0xbef840,
-    0xac1c00, 0xada8c0, 0xaf7580, 0xaec140, 0xaacf00, 0xab7bc0, 0xa9a680, 0xa81240,
-    0xa1ba00, 0xa00ec0, 0xa2d380, 0xa36740, 0xa76900, 0xa6ddc0, 0xa40080, 0xa5b440,
-    0x81c800, 0x807cc0, 0x82a180, 0x831540, 0x871b00, 0x86afc0, 0x847280, 0x85c640,
-    0x8c6e00, 0x8ddac0, 0x8f0780, 0x8eb340, 0x8abd00, 0x8b09c0, 0x89d480, 0x886040,
-    0x9a8400, 0x9b30c0, 0x99ed80, 0x985940, 0x9c5700, 0x9de3c0, 0x9f3e80, 0x9e8a40,
-    0x972200, 0x9696c0, 0x944b80, 0x95ff40, 0x91f100, 0x9045c0, 0x929880, 0x932c40
-};
+#define CRC_CLMUL_MIN_LEN 32
+
+/* -1: not yet checked, 0: not supported, 1: supported */
+static int crc_clmul_supported = -1;
 
-static uint32_t crc_update_ble(uint32_t crc, const void *data, size_t data_len)
+static bool crc_clmul_check(void){
+  if (crc_clmul_supported < 0) {
+    unsigned int eax, ebx, ecx, edx;
+    crc_clmul_supported = 0;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)
+        && (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1)) {
+      crc_clmul_supported = 1;
+    }
+  }
+  return crc_clmul_supported;
+}
+
+/**
+ * Calculate the CRC of <data_len> bytes (a multiple of 16, and at least 16)
+ * by folding with carry-less multiplications.
+ * It is the algorithm in the Intel paper referenced in crc_engine_build_clmul(),
+ * for the bit reflected case.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc_update_clmul(const crc_engine_t *engine, uint32_t crc,
+                                 const uint8_t *d, size_t data_len)
 {
-  const unsigned char *d = (const unsigned char *)data;
-  unsigned int tbl_idx;
+  const __m128i k1k2 = _mm_loadu_si128((const __m128i *)&engine->fold_k[0]);
+  const __m128i k3k4 = _mm_loadu_si128((const __m128i *)&engine->fold_k[2]);
+  const __m128i k5k0 = _mm_loadu_si128((const __m128i *)&engine->fold_k[4]);
+  const __m128i poly = _mm_loadu_si128((const __m128i *)&engine->fold_k[6]);
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+  __m128i x1, x2, x3, x4, x5, x6, x7, x8;
 
-  while (data_len--) {
-    tbl_idx = (crc ^ *d) & 0xff;
-    crc = (crc_table_24_ble[tbl_idx] ^ (crc >> 8)) & 0xffffff;
+  x1 = _mm_loadu_si128((const __m128i *)d);
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+  d += 16;
+  data_len -= 16;
 
-    d++;
+  if (data_len >= 48) {
+    /* Fold 4 blocks of 16 bytes in parallel */
+    x2 = _mm_loadu_si128((const __m128i *)(d + 0x00));
+    x3 = _mm_loadu_si128((const __m128i *)(d + 0x10));
+    x4 = _mm_loadu_si128((const __m128i *)(d + 0x20));
+    d += 48;
+    data_len -= 48;
+
+    while (data_len >= 64) {
+      x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+      x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+      x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+      x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+      x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+      x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+      x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+      x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(d + 0x00)));
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(d + 0x10)));
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(d + 0x20)));
+      x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(d + 0x30)));
+      d += 64;
+      data_len -= 64;
+    }
+
+    /* Fold the 4 blocks into 1 */
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+  }
+
+  while (data_len >= 16) {
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)d));
+    d += 16;
+    data_len -= 16;
   }
-  return crc & 0xffffff;
+
+  /* Fold 128 bits into 64 */
+  x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  /* Barrett reduction into 32 bits */
+  x2 = _mm_and_si128(x1, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+  x2 = _mm_and_si128(x2, mask32);
+  x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return _mm_extract_epi32(x1, 1);
 }
+#endif
 
+static uint32_t crc_update(const crc_engine_t *engine, uint32_t crc,
+                           const void *data, size_t data_len)
+{
+  const uint8_t *d = (const uint8_t *)data;
+  const uint32_t (*t)[256] = engine->table;
+
+#if CRC_HAVE_CLMUL
+  if ((data_len >= CRC_CLMUL_MIN_LEN) && crc_clmul_check()) {
+    size_t n = data_len & ~(size_t)15;
+    crc = crc_update_clmul(engine, crc, d, n);
+    d += n;
+    data_len -= n;
+  }
+#endif
+
+  while (data_len >= 8) {
+    uint32_t one = crc ^ (d[0] | (uint32_t)d[1] << 8 | (uint32_t)d[2] << 16 | (uint32_t)d[3] << 24);
+    crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff]
+        ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24]
+        ^ t[3][d[4]] ^ t[2][d[5]] ^ t[1][d[6]] ^ t[0][d[7]];
+    d += 8;
+    data_len -= 8;
+  }
+  while (data_len--) {
+    crc = t[0][(crc ^ *d) & 0xff] ^ (crc >> 8);
+    d++;
+  }
+  return crc;
+}
 
 /**
- * Append the BLE CRC to a buffer buf of len bytes at the end of the buffer
- * itself
+ * Append a CRC of <crc_len> bytes (1 to 3) to a buffer buf of len bytes at the
+ * end of the buffer itself.
+ * The CRC is calculated LSB first, with the polynomial <crc_poly> and initial
+ * value <crc_init>, with the same meaning as the RADIO CRCPOLY and CRCINIT registers
+ * (the x^0 term is always 1, and the x^(8*crc_len) term is implicit)
  */
-void append_crc_ble(uint8_t* buf, unsigned int len, uint32_t crc_init)
+void append_crc(uint8_t* buf, unsigned int len,
+                unsigned int crc_len, uint32_t crc_poly, uint32_t crc_init)
 {
+  const crc_engine_t *engine;
+  uint32_t mask;
   uint32_t crc;
-  crc = crc_update_ble( rev_24(crc_init), buf, len );
+
+  if ((crc_len == 0) || (crc_len > 3)) {
+    return;
+  }
+  mask = (1UL << (crc_len*8)) - 1;
+
+  engine = crc_engine_get(crc_len, (crc_poly | 1) & mask);
+  crc = crc_update(engine, rev_bits(crc_init & mask, crc_len), buf, len);
 
   /*Copy CRC itself at the end of the input buffer*/
-  for (int i = 0; i < 3; i++) {
+  for (unsigned int i = 0; i < crc_len; i++) {
     buf[len + i] = (crc >> (i*8)) & 0xff;
   }
-  return;
 }
 
+/**
+ * Gather the <n_segs> segments <segs> into <dst>, followed by their CRC
+ * (calculated only over the segments marked as covered by it).
+ * <crc_len>, <crc_poly> and <crc_init> are as in append_crc().
+ *
+ * Returns the number of bytes written into <dst> (including the CRC)
+ */
+size_t crc_gather_append(uint8_t *dst, const crc_seg_t *segs, unsigned int n_segs,
+                         unsigned int crc_len, uint32_t crc_poly, uint32_t crc_init)
+{
+  const crc_engine_t *engine = NULL;
+  uint32_t crc = 0;
+  size_t len = 0;
+  size_t run_start = 0; /* Start of the current run of consecutive segments covered by the CRC */
+
+  if ((crc_len > 0) && (crc_len <= 3)) {
+    uint32_t mask = (1UL << (crc_len*8)) - 1;
+    engine = crc_engine_get(crc_len, (crc_poly | 1) & mask);
+    crc = rev_bits(crc_init & mask, crc_len);
+  } else {
+    crc_len = 0;
+  }
 
-/*
- Table implementation of the CRCs autogenerated with these scripts (with very minor changes)
- https://pycrc.org (These python scripts are MIT licensed)
- mkdir pycrc && cd pycrc
- git clone git@github.com:tpircher/pycrc.git .
-
- Options="--std=C99 --width=16 --poly=0x1021 --algorithm=table-driven --reflect-in=true --reflect-out=true --crc-type=uint16_t"
- python3 src/pycrc.py $Options --generate=h > pycrc_stdout.h
- python3 src/pycrc.py $Options --generate=c-main  > pycrc_stdout.c
-*/
-static const uint16_t crc_table_154[256] = {
-    0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
-    0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
-    0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
-    0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
-    0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
-    0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
-    0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
-    0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
-    0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
-    0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
-    0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
-    0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
-    0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
-    0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
-    0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
-    0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
-    0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
-    0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
-    0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
-    0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
-    0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
-    0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
-    0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
-    0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
-    0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
-    0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
-    0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
-    0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
-    0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
-    0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
-    0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
-    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
-};
+  /* The CRC is calculated over the gathered data, so consecutive segments
+   * are processed in one go (as the CRC is faster the longer the run) */
+  for (unsigned int i = 0; i < n_segs; i++) {
+    if (!segs[i].crc) {
+      if ((engine != NULL) && (len > run_start)) {
+        crc = crc_update(engine, crc, &dst[run_start], len - run_start);
+      }
+      run_start = len + segs[i].len;
+    }
+    memcpy(&dst[len], segs[i].data, segs[i].len);
+    len += segs[i].len;
+  }
+  if ((engine != NULL) && (len > run_start)) {
+    crc = crc_update(engine, crc, &dst[run_start], len - run_start);
+  }
 
-uint16_t crc_update_154(uint16_t crc, const void *data, size_t data_len)
+  for (unsigned int i = 0; i < crc_len; i++) {
+    dst[len++] = (crc >> (i*8)) & 0xff;
+  }
+  return len;
+}
+
+/**
+ * Append the BLE CRC to a buffer buf of len bytes at the end of the buffer
+ * itself
+ */
+void append_crc_ble(uint8_t* buf, unsigned int len, uint32_t crc_init)
 {
-    const unsigned char *d = (const unsigned char *)data;
-    unsigned int tbl_idx;
+  append_crc(buf, len, 3, 0x00065B, crc_init);
+}
 
-    while (data_len--) {
-        tbl_idx = (crc ^ *d) & 0xff;
-        crc = (crc_table_154[tbl_idx] ^ (crc >> 8)) & 0xffff;
-        d++;
-    }
-    return crc & 0xffff;
+uint16_t crc_update_154(uint16_t crc, const void *data, size_t data_len)
+{
+  return crc_update(crc_engine_get(2, 0x1021), crc, data, data_len);
 }
 
 /**
@@ -178,14 +426,7 @@ uint16_t crc_update_154(uint16_t crc, const void *data, size_t data_len)
  */
 void append_crc_154(uint8_t* buf, unsigned int len, uint16_t crc_init)
 {
-  uint16_t crc;
-  crc = crc_update_154( rev_16(crc_init), buf, len );
-
-  /*Copy CRC itself at the end of the input buffer*/
-  for (int i = 0; i < 2; i++) {
-    buf[len + i] = (crc >> (i*8)) & 0xff;
-  }
-  return;
+  append_crc(buf, len, 2, 0x1021, crc_init);
 }
 
 #if defined(__TEST_CRC_154)
@@ -220,3 +461,78 @@ int main(){
   }
 }
 #endif //defined(__TEST_CRC_154)
+
+#if defined(__TEST_CRC_CLMUL)
+//Check the carry-less multiplication CRC is bit exact with the table one, and benchmark both
+// gcc -O2 -D__TEST_CRC_CLMUL crc.c -o crc_clmultest && ./crc_clmultest
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+static double bench_ns(const crc_engine_t *engine, const uint8_t *buf, size_t len){
+  struct timespec t0, t1;
+  volatile uint32_t sink = 0;
+  const int n = 1000000;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (int i = 0; i < n; i++) {
+    sink += crc_update(engine, i, buf, len);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return ((t1.tv_sec - t0.tv_sec)*1e9 + (t1.tv_nsec - t0.tv_nsec))/n;
+}
+
+int main(){
+  const crc_engine_t *engines[2] = {crc_engine_get(3, 0x00065B), crc_engine_get(2, 0x1021)};
+  const char *names[2] = {"BLE", "15.4"};
+  uint8_t buffer[300];
+  int errors = 0;
+
+  if (!crc_clmul_check()) {
+    printf("This CPU does not support PCLMULQDQ -> SKIPPED\n");
+    return 0;
+  }
+
+  srand(0);
+  for (int i = 0; i < 100000; i++) {
+    size_t len = rand() % sizeof(buffer);
+    uint32_t seed = rand() & 0xFFFFFF;
+    for (size_t j = 0; j < len; j++) {
+      buffer[j] = rand();
+    }
+    for (int e = 0; e < 2; e++) {
+      uint32_t mask = (e == 0) ? 0xFFFFFF : 0xFFFF;
+      uint32_t crc_clmul, crc_table;
+      crc_clmul_supported = 1;
+      crc_clmul = crc_update(engines[e], seed & mask, buffer, len);
+      crc_clmul_supported = 0;
+      crc_table = crc_update(engines[e], seed & mask, buffer, len);
+      if (crc_clmul != crc_table) {
+        printf("%s CRC mismatch (len %zu, seed 0x%06X): 0x%06X != 0x%06X\n",
+               names[e], len, seed, crc_clmul, crc_table);
+        errors++;
+      }
+    }
+  }
+
+  for (int e = 0; e < 2; e++) {
+    size_t lens[] = {32, 64, 128, 257};
+    for (unsigned int l = 0; l < sizeof(lens)/sizeof(lens[0]); l++) {
+      crc_clmul_supported = 0;
+      double t_table = bench_ns(engines[e], buffer, lens[l]);
+      crc_clmul_supported = 1;
+      double t_clmul = bench_ns(engines[e], buffer, lens[l]);
+      printf("%4s CRC, %3zu bytes: table %6.1fns, clmul %6.1fns\n",
+             names[e], lens[l], t_table, t_clmul);
+    }
+  }
+
+  if (errors == 0) {
+    printf("CRCs were bit exact -> PASSED\n");
+    return 0;
+  } else {
+    printf("%i CRCs were NOT bit exact -> FAILED\n", errors);
+    return 1;
+  }
+}
+#endif //defined(__TEST_CRC_CLMUL)
@@ -8,11 +8,23 @@
 #define _CRC_BLE_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  bool crc; /* Is this segment covered by the CRC */
+} crc_seg_t;
+
+size_t crc_gather_append(uint8_t *dst, const crc_seg_t *segs, unsigned int n_segs,
+                         unsigned int crc_len, uint32_t crc_poly, uint32_t crc_init);
+void append_crc(uint8_t* buf, unsigned int len,
+                unsigned int crc_len, uint32_t crc_poly, uint32_t crc_init);
 void append_crc_ble(uint8_t* buf, unsigned int len, uint32_t crc_init);
 void append_crc_154(uint8_t* buf, unsigned int len, uint16_t crc_init);
 
@@ -13,11 +13,16 @@
 #include "bs_types.h"
 #include "irq_ctrl.h"
 #include "NRF_HW_model_top.h"
+#include "fake_timer.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_fake_timer = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_fake_timer = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t fake_timer;
 
 void fake_timer_init()
 {
+	fake_timer = nrf_hw_timer_register("fake timer", NRF_HW_TIMER_PRIO_FAKE_TIMER, fake_timer_triggered);
+
 	Timer_fake_timer = TIME_NEVER;
 }
 
@@ -38,13 +43,13 @@ void fake_timer_wake_in_time(bs_time_t time)
 {
 	if (Timer_fake_timer > time) {
 		Timer_fake_timer = time;
-		nrf_hw_find_next_timer_to_trigger();
+		nrf_hw_timer_update(fake_timer, Timer_fake_timer);
 	}
 }
 
 void fake_timer_triggered(void)
 {
 	Timer_fake_timer = TIME_NEVER;
-	nrf_hw_find_next_timer_to_trigger();
+	nrf_hw_timer_update(fake_timer, Timer_fake_timer);
 	hw_irq_ctrl_set_irq(PHONY_HARD_IRQ);
 }
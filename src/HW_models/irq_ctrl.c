@@ -12,17 +12,26 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 #include "bs_types.h"
 #include "bs_tracing.h"
+#include "bs_oswrap.h"
+#include "bs_cmd_line.h"
+#include "bs_compat.h"
 #include "irq_ctrl.h"
 #include "time_machine_if.h"
 #include "NRF_HW_model_top.h"
+#include "NRF_HW_ctx.h"
 
-bs_time_t Timer_irq_ctrl = TIME_NEVER;
+NRF_HW_STATE bs_time_t Timer_irq_ctrl = TIME_NEVER;
+static NRF_HW_STATE nrf_hw_timer_handle_t irq_ctrl_timer;
 
-static uint64_t irq_lines; /*Level of interrupt lines from peripherals*/
-static uint64_t irq_status;  /*pended and not masked interrupts*/
-static uint64_t irq_premask; /*pended interrupts before the mask*/
+static NRF_HW_STATE uint64_t irq_lines; /*Level of interrupt lines from peripherals*/
+static NRF_HW_STATE uint64_t irq_status;  /*pended and not masked interrupts*/
+static NRF_HW_STATE uint64_t irq_premask; /*pended interrupts before the mask*/
 
 /*
  * Mask of which interrupts will actually cause the cpu to vector into its
@@ -32,20 +41,70 @@ static uint64_t irq_premask; /*pended interrupts before the mask*/
  * If the irq_mask enables and interrupt pending in irq_premask, it will cause
  * the controller to raise the interrupt immediately
  */
-static uint64_t irq_mask;
+static NRF_HW_STATE uint64_t irq_mask;
 
 /*
  * Interrupts lock/disable. When set, interrupts are registered
  * (in the irq_status) but do not awake the cpu. if when unlocked,
  * irq_status != 0 an interrupt will be raised immediately
  */
-static bool irqs_locked;
-static bool lock_ignore; /*For the hard fake IRQ, temporarily ignore lock*/
+static NRF_HW_STATE bool irqs_locked;
+static NRF_HW_STATE bool lock_ignore; /*For the hard fake IRQ, temporarily ignore lock*/
 
-static uint8_t irq_prio[NRF_HW_NBR_IRQs]; /*Priority of each interrupt*/
+static NRF_HW_STATE uint8_t irq_prio[NRF_HW_NBR_IRQs]; /*Priority of each interrupt*/
 /*note that prio = 0 == highest, prio=255 == lowest*/
 
-static int currently_running_prio = 256; /*255 is the lowest prio interrupt*/
+static NRF_HW_STATE int currently_running_prio = 256; /*255 is the lowest prio interrupt*/
+
+/*
+ * irq_status split by priority:
+ * prio_status[p] holds the bits of irq_status of the interrupts with priority p,
+ * and bit p of prio_levels is set when prio_status[p] is not empty.
+ * So the highest priority pending interrupt is found with a find-first-set
+ * over prio_levels and another over that level prio_status.
+ *
+ * The NVIC only implements 3 priority bits, but the priorities are kept here
+ * as set by the SW (full 8 bits), so there is one level per priority value.
+ */
+#define IRQ_PRIO_LEVELS 256
+static NRF_HW_STATE uint64_t prio_status[IRQ_PRIO_LEVELS];
+static NRF_HW_STATE uint64_t prio_levels[IRQ_PRIO_LEVELS/64];
+
+/*
+ * Functions which re-evaluate the level of a peripheral interrupt line
+ * (see hw_irq_ctrl_set_line_eval())
+ */
+static hw_irq_ctrl_line_eval_t irq_line_eval[NRF_HW_NBR_IRQs];
+
+/*
+ * Optional interrupts statistics (-irq_stats_file):
+ * For each interrupt, how many times it was raised (became pending),
+ * how many times it was cleared/serviced, a histogram of how long it was
+ * pending until then, and how many times it was raised in each simulated
+ * second.
+ * Dumped at exit in <irq_stats_path> (see irq_stats_dump())
+ */
+static char *irq_stats_path; /*Command line option, shared by all devices*/
+static NRF_HW_STATE_LOCAL bool irq_stats_on;
+
+/*
+ * Latency histogram buckets: 0 = less than 1us,
+ * n = [2^(n-1), 2^n) us, the last one also holding anything longer
+ */
+#define IRQ_STATS_LAT_BUCKETS 32
+
+static NRF_HW_STATE_LOCAL struct {
+	bs_time_t pend_time; /*When it was pended (TIME_NEVER if not pending)*/
+	uint64_t raises;
+	uint64_t serviced;
+	bs_time_t lat_max;
+	bs_time_t lat_sum;
+	uint64_t lat_hist[IRQ_STATS_LAT_BUCKETS];
+} *irq_stats; /*[NRF_HW_NBR_IRQs], allocated only when enabled*/
+
+/*Raises per interrupt in each simulated second (irq_stats_rate[second][irq])*/
+static NRF_HW_STATE_LOCAL uint32_t (*irq_stats_rate)[NRF_HW_NBR_IRQs];
+static NRF_HW_STATE_LOCAL uint64_t irq_stats_rate_n; /*Number of seconds allocated*/
 
 /*
  * These functions are provided by the board
@@ -54,8 +113,176 @@ extern void posix_interrupt_raised(void);
 extern void posix_irq_handler_im_from_sw(void);
 
 
+static inline void irq_status_set(unsigned int irq)
+{
+	uint64_t irq_bit = ((uint64_t)1<<irq);
+	unsigned int prio = irq_prio[irq];
+
+	irq_status |= irq_bit;
+	prio_status[prio] |= irq_bit;
+	prio_levels[prio / 64] |= ((uint64_t)1 << (prio % 64));
+}
+
+/*
+ * Clear from irq_status the interrupts set in <mask>
+ */
+static inline void irq_status_clear(uint64_t mask)
+{
+	uint64_t to_clear = irq_status & mask;
+
+	irq_status &= ~mask;
+	while (to_clear != 0) {
+		int irq_nbr = __builtin_ctzll(to_clear);
+		unsigned int prio = irq_prio[irq_nbr];
+
+		to_clear &= to_clear - 1;
+		prio_status[prio] &= ~((uint64_t)1 << irq_nbr);
+		if (prio_status[prio] == 0) {
+			prio_levels[prio / 64] &= ~((uint64_t)1 << (prio % 64));
+		}
+	}
+}
+
+static void irq_stats_init(void)
+{
+	irq_stats_on = (irq_stats_path != NULL);
+	if (!irq_stats_on) {
+		return;
+	}
+	irq_stats = bs_calloc(NRF_HW_NBR_IRQs, sizeof(*irq_stats));
+	for (int i = 0 ; i < NRF_HW_NBR_IRQs; i++) {
+		irq_stats[i].pend_time = TIME_NEVER;
+	}
+}
+
+static void irq_stats_raised(unsigned int irq)
+{
+	bs_time_t now = tm_get_hw_time();
+	uint64_t second = now / 1000000;
+
+	irq_stats[irq].raises++;
+	if (irq_stats[irq].pend_time == TIME_NEVER) {
+		irq_stats[irq].pend_time = now;
+	}
+
+	if (second >= irq_stats_rate_n) {
+		uint64_t new_n = BS_MAX(second + 1, 2*irq_stats_rate_n);
+
+		irq_stats_rate = bs_realloc(irq_stats_rate, new_n*sizeof(irq_stats_rate[0]));
+		memset(&irq_stats_rate[irq_stats_rate_n], 0,
+		       (new_n - irq_stats_rate_n)*sizeof(irq_stats_rate[0]));
+		irq_stats_rate_n = new_n;
+	}
+	irq_stats_rate[second][irq]++;
+}
+
+/*
+ * The interrupts in <mask> have been cleared (serviced)
+ */
+static void irq_stats_cleared(uint64_t mask)
+{
+	bs_time_t now = tm_get_hw_time();
+
+	mask &= ((uint64_t)1 << NRF_HW_NBR_IRQs) - 1;
+	while (mask != 0) {
+		int irq_nbr = __builtin_ctzll(mask);
+		bs_time_t lat;
+		int bucket;
+
+		mask &= mask - 1;
+		if (irq_stats[irq_nbr].pend_time == TIME_NEVER) {
+			continue;
+		}
+		lat = now - irq_stats[irq_nbr].pend_time;
+		irq_stats[irq_nbr].pend_time = TIME_NEVER;
+		irq_stats[irq_nbr].serviced++;
+		irq_stats[irq_nbr].lat_sum += lat;
+		irq_stats[irq_nbr].lat_max = BS_MAX(irq_stats[irq_nbr].lat_max, lat);
+		bucket = (lat == 0) ? 0 : 64 - __builtin_clzll(lat);
+		irq_stats[irq_nbr].lat_hist[BS_MIN(bucket, IRQ_STATS_LAT_BUCKETS - 1)]++;
+	}
+}
+
+/*
+ * Dump the interrupts statistics as a CSV file, with one row per value:
+ *  irq,name,metric,key,value
+ * with metric one of:
+ *  raises, serviced, latency_mean_us, latency_max_us (key empty),
+ *  latency_hist (key = lower bound in us of the histogram bucket),
+ *  raises_per_s (key = simulated second, only seconds with raises)
+ */
+static void irq_stats_dump(void)
+{
+	unsigned int ctx_id = nrf_hw_ctx_get_id(nrf_hw_ctx_get_active());
+	char *path = irq_stats_path;
+	FILE *file;
+
+	/* Each device (context) other than the default one gets <path>.<ctx id> */
+	if (ctx_id != 0) {
+		path = bs_calloc(strlen(irq_stats_path) + 12, sizeof(char));
+		sprintf(path, "%s.%u", irq_stats_path, ctx_id);
+	}
+	_bs_create_folders_in_path(path);
+	file = bs_fopen(path, "w");
+	if (path != irq_stats_path) {
+		free(path);
+	}
+	fprintf(file, "irq,name,metric,key,value\n");
+
+	for (int i = 0 ; i < NRF_HW_NBR_IRQs; i++) {
+		const char *name = hw_irq_ctrl_get_name(i);
+
+		if (irq_stats[i].raises == 0) {
+			continue;
+		}
+		if (name == NULL) {
+			name = "";
+		}
+		fprintf(file, "%i,%s,raises,,%"PRIu64"\n", i, name, irq_stats[i].raises);
+		fprintf(file, "%i,%s,serviced,,%"PRIu64"\n", i, name, irq_stats[i].serviced);
+		if (irq_stats[i].serviced > 0) {
+			fprintf(file, "%i,%s,latency_mean_us,,%.3f\n", i, name,
+				(double)irq_stats[i].lat_sum/irq_stats[i].serviced);
+			fprintf(file, "%i,%s,latency_max_us,,%"PRItime"\n", i, name,
+				irq_stats[i].lat_max);
+		}
+		for (int b = 0; b < IRQ_STATS_LAT_BUCKETS; b++) {
+			if (irq_stats[i].lat_hist[b] > 0) {
+				fprintf(file, "%i,%s,latency_hist,%"PRIu64",%"PRIu64"\n", i, name,
+					b == 0 ? 0 : (uint64_t)1 << (b - 1), irq_stats[i].lat_hist[b]);
+			}
+		}
+		for (uint64_t sec = 0; sec < irq_stats_rate_n; sec++) {
+			if (irq_stats_rate[sec][i] > 0) {
+				fprintf(file, "%i,%s,raises_per_s,%"PRIu64",%"PRIu32"\n", i, name,
+					sec, irq_stats_rate[sec][i]);
+			}
+		}
+	}
+	fclose(file);
+}
+
+void hw_irq_ctrl_pre_init(void)
+{
+	static bs_args_struct_t args_struct_toadd[] = {
+	{ .option = "irq_stats_file",
+	  .name = "path",
+	  .type = 's',
+	  .dest = (void *)&irq_stats_path,
+	  .descript = "Keep statistics of each interrupt (raises, raises per simulated second, "
+		      "and histogram of the time they are pending until serviced), "
+		      "and save them in this file (CSV) at exit"
+	},
+	ARG_TABLE_ENDMARKER
+	};
+
+	bs_add_extra_dynargs(args_struct_toadd);
+}
+
 void hw_irq_ctrl_init(void)
 {
+	irq_ctrl_timer = nrf_hw_timer_register("IRQ ctrl timer", NRF_HW_TIMER_PRIO_IRQ_CTRL, hw_irq_ctrl_timer_triggered);
+
 	irq_mask = 0; /*Let's assume all interrupts are disable at boot*/
 	irq_premask = 0;
 	irqs_locked = false;
@@ -64,11 +291,21 @@ void hw_irq_ctrl_init(void)
 	for (int i = 0 ; i < NRF_HW_NBR_IRQs; i++) {
 		irq_prio[i] = 255;
 	}
+
+	irq_stats_init();
 }
 
 void hw_irq_ctrl_cleanup(void)
 {
-	/*Nothing to be done*/
+	if (irq_stats_on) {
+		irq_stats_dump();
+		free(irq_stats);
+		irq_stats = NULL;
+		free(irq_stats_rate);
+		irq_stats_rate = NULL;
+		irq_stats_rate_n = 0;
+		irq_stats_on = false;
+	}
 }
 
 void hw_irq_ctrl_set_cur_prio(int new)
@@ -83,7 +320,15 @@ int hw_irq_ctrl_get_cur_prio(void)
 
 void hw_irq_ctrl_prio_set(unsigned int irq, unsigned int prio)
 {
-	irq_prio[irq] = prio;
+	uint64_t irq_bit = ((uint64_t)1<<irq);
+
+	if (irq_status & irq_bit) { /*Move it to its new level*/
+		irq_status_clear(irq_bit);
+		irq_prio[irq] = prio;
+		irq_status_set(irq);
+	} else {
+		irq_prio[irq] = prio;
+	}
 }
 
 uint8_t hw_irq_ctrl_get_prio(unsigned int irq)
@@ -103,21 +348,18 @@ int hw_irq_ctrl_get_highest_prio_irq(void)
 		return -1;
 	}
 
-	uint64_t irq_status = hw_irq_ctrl_get_irq_status();
-	int winner = -1;
-	int winner_prio = 256;
-
-	while (irq_status != 0) {
-		int irq_nbr = __builtin_ffs(irq_status) - 1;
+	for (int i = 0; i < IRQ_PRIO_LEVELS/64; i++) {
+		if (prio_levels[i] != 0) {
+			int prio = i*64 + __builtin_ctzll(prio_levels[i]);
 
-		irq_status &= ~((uint64_t) 1 << irq_nbr);
-		if ((winner_prio > (int)irq_prio[irq_nbr])
-		   && (currently_running_prio > (int)irq_prio[irq_nbr])) {
-			winner = irq_nbr;
-			winner_prio = irq_prio[irq_nbr];
+			if (currently_running_prio <= prio) {
+				return -1;
+			}
+			/*On ties, the lowest interrupt number wins*/
+			return __builtin_ctzll(prio_status[prio]);
 		}
 	}
-	return winner;
+	return -1;
 }
 
 uint32_t hw_irq_ctrl_get_current_lock(void)
@@ -151,13 +393,19 @@ uint64_t hw_irq_ctrl_get_irq_status(void)
 
 void hw_irq_ctrl_clear_all_enabled_irqs(void)
 {
-	irq_status  = 0;
+	if (irq_stats_on) {
+		irq_stats_cleared(irq_premask & irq_mask);
+	}
+	irq_status_clear(UINT64_MAX);
 	irq_premask &= ~irq_mask;
 }
 
 void hw_irq_ctrl_clear_all_irqs(void)
 {
-	irq_status  = 0;
+	if (irq_stats_on) {
+		irq_stats_cleared(irq_premask);
+	}
+	irq_status_clear(UINT64_MAX);
 	irq_premask = 0;
 }
 
@@ -187,8 +435,15 @@ uint64_t hw_irq_ctrl_get_irq_mask(void)
  */
 void hw_irq_ctrl_clear_irq(unsigned int irq)
 {
-	irq_status  &= ~((uint64_t)1<<irq);
+	if (irq_stats_on) {
+		irq_stats_cleared(irq_premask & ((uint64_t)1<<irq));
+	}
+	irq_status_clear((uint64_t)1<<irq);
 	irq_premask &= ~((uint64_t)1<<irq);
+
+	if (irq_line_eval[irq] != NULL) {
+		irq_line_eval[irq](irq);
+	}
 }
 
 /*
@@ -204,11 +459,18 @@ void hw_irq_ctrl_reeval_level_irq(unsigned int irq)
 {
 	uint64_t irq_bit = ((uint64_t)1<<irq);
 
+	if (irq_line_eval[irq] != NULL) {
+		irq_line_eval[irq](irq);
+	}
+
 	if ((irq_lines & irq_bit) != 0) {
+		if (irq_stats_on && ((irq_premask & irq_bit) == 0)) {
+			irq_stats_raised(irq);
+		}
 		irq_premask |= irq_bit;
 
 		if (irq_mask & irq_bit) {
-			irq_status |= irq_bit;
+			irq_status_set(irq);
 		}
 	}
 }
@@ -233,10 +495,14 @@ void hw_irq_ctrl_enable_irq(unsigned int irq)
 static inline void hw_irq_ctrl_irq_raise_prefix(unsigned int irq)
 {
 	if ( irq < NRF_HW_NBR_IRQs ) {
+		/* Only count it if it was not already pending */
+		if (irq_stats_on && ((irq_premask & ((uint64_t)1<<irq)) == 0)) {
+			irq_stats_raised(irq);
+		}
 		irq_premask |= ((uint64_t)1<<irq);
 
 		if (irq_mask & ((uint64_t)1<<irq)) {
-			irq_status |= ((uint64_t)1<<irq);
+			irq_status_set(irq);
 		}
 	} else if (irq == PHONY_HARD_IRQ) {
 		lock_ignore = true;
@@ -264,7 +530,7 @@ void hw_irq_ctrl_set_irq(unsigned int irq)
 		 * being marked as pending
 		 */
 	    Timer_irq_ctrl = tm_get_hw_time();
-	    nrf_hw_find_next_timer_to_trigger();
+	    nrf_hw_timer_update(irq_ctrl_timer, Timer_irq_ctrl);
 	}
 }
 
@@ -307,6 +573,43 @@ void hw_irq_ctrl_lower_level_irq_line(unsigned int irq)
 	irq_lines &= ~((uint64_t)1<<irq);
 }
 
+/**
+ * Update the level of a HW peripheral interrupt line
+ *
+ * <int_line> is where the peripheral keeps the level it is driving,
+ * and <new_int_line> the level it should now drive.
+ * The interrupt is only pended on a rising edge of the line
+ * (and re-pended by hw_irq_ctrl_reeval_level_irq() if it is still high
+ * when the CPU exits its handler)
+ */
+void hw_irq_ctrl_update_irq_lines(bool *int_line, bool new_int_line, unsigned int irq)
+{
+	if ((*int_line == false) && (new_int_line == true)) {
+		*int_line = true;
+		hw_irq_ctrl_raise_level_irq_line(irq);
+	} else if ((*int_line == true) && (new_int_line == false)) {
+		*int_line = false;
+		hw_irq_ctrl_lower_level_irq_line(irq);
+	}
+}
+
+/**
+ * Register a function which re-evaluates (with hw_irq_ctrl_update_irq_lines())
+ * the level of the interrupt line <irq>.
+ *
+ * This is meant for peripherals whose events the SW may clear by just
+ * writing to their registers, without the model being notified.
+ * It is called before the interrupt controller checks the line level when
+ * the CPU exits the interrupt handler, and when the interrupt is cleared.
+ */
+void hw_irq_ctrl_set_line_eval(unsigned int irq, hw_irq_ctrl_line_eval_t eval)
+{
+	if ( irq >= NRF_HW_NBR_IRQs ) {
+		bs_trace_error_line("Phony interrupts cannot use this API\n");
+	}
+	irq_line_eval[irq] = eval;
+}
+
 
 static void irq_raising_from_hw_now(void)
 {
@@ -355,7 +658,7 @@ void hw_irq_ctrl_timer_triggered(void)
 {
   Timer_irq_ctrl = TIME_NEVER;
   irq_raising_from_hw_now();
-  nrf_hw_find_next_timer_to_trigger();
+  nrf_hw_timer_update(irq_ctrl_timer, Timer_irq_ctrl);
 }
 
 const char *hw_irq_ctrl_get_name(unsigned int irq)
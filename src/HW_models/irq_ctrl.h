@@ -8,11 +8,13 @@
 #define _IRQ_CTRL_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+void hw_irq_ctrl_pre_init(void);
 void hw_irq_ctrl_init(void);
 void hw_irq_ctrl_cleanup(void);
 void hw_irq_ctrl_raise_im(uint32_t irq);
@@ -29,6 +31,9 @@ void hw_irq_ctrl_timer_triggered();
 void hw_irq_ctrl_set_irq(unsigned int irq);
 void hw_irq_ctrl_raise_level_irq_line(unsigned int irq);
 void hw_irq_ctrl_lower_level_irq_line(unsigned int irq);
+void hw_irq_ctrl_update_irq_lines(bool *int_line, bool new_int_line, unsigned int irq);
+typedef void (*hw_irq_ctrl_line_eval_t)(unsigned int irq);
+void hw_irq_ctrl_set_line_eval(unsigned int irq, hw_irq_ctrl_line_eval_t eval);
 void hw_irq_ctrl_raise_im(unsigned int irq);
 void hw_irq_ctrl_raise_im_from_sw(unsigned int irq);
 uint32_t hw_irq_ctrl_get_current_lock(void);
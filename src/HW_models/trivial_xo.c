@@ -7,9 +7,10 @@
 
 #include "bs_tracing.h"
 #include "bs_types.h"
+#include "NRF_HW_ctx.h"
 
-static double xo_drift = 0.0; //Crystal oscillator drift relative to the phy
-static double time_off = 0.0; //Time offset relative to the phy
+static NRF_HW_STATE double xo_drift = 0.0; //Crystal oscillator drift relative to the phy
+static NRF_HW_STATE double time_off = 0.0; //Time offset relative to the phy
 
 long double __attribute__((weak)) dev_time_from_phy(long double p_t){
   long double dev_time;
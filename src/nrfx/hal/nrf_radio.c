@@ -38,6 +38,12 @@ void nrf_radio_task_trigger(NRF_RADIO_Type * p_reg, nrf_radio_task_t task)
   }
 }
 
+void nrf_radio_event_clear(NRF_RADIO_Type * p_reg, nrf_radio_event_t event)
+{
+  *((volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event)) = 0x0UL;
+  nrf_radio_regw_sideeffects_EVENTS_all();
+}
+
 void nrf_radio_int_enable(NRF_RADIO_Type * p_reg, uint32_t mask)
 {
   p_reg->INTENSET = mask;
@@ -63,6 +63,13 @@ void nrf_rtc_task_trigger(NRF_RTC_Type * p_reg, nrf_rtc_task_t task)
   }
 }
 
+void nrf_rtc_event_clear(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+  int i = rtc_number_from_ptr(p_reg);
+  *((volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event)) = 0x0UL;
+  nrf_rtc_regw_sideeffect_EVENTS_all(i);
+}
+
 void nrf_rtc_event_enable(NRF_RTC_Type * p_reg, uint32_t mask)
 {
   int i = rtc_number_from_ptr(p_reg);